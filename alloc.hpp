@@ -0,0 +1,294 @@
+#ifndef ALLOC_HPP
+#define ALLOC_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+
+using namespace std;
+
+// Политики выделения памяти для контейнеров (Array, DoubleHash).
+// Политика — тип без состояния со статическими функциями:
+//   allocate(bytes, align) -> void*
+//   deallocate(ptr, bytes, align)
+//   CanReallocate / reallocate(ptr, oldBytes, newBytes, align) — расширение
+//   побайтно переносимых данных (realloc); при false контейнер копирует сам.
+// Без состояния политика не хранится в контейнере и не мешает копированию и обмену
+
+// Куча: malloc/free, для больших выравниваний — выровненный operator new
+struct HeapAllocator {
+    static constexpr bool CanReallocate = true;
+
+    static void* allocate(size_t bytes, size_t align) {
+        if (align > alignof(max_align_t)) {
+            return ::operator new(bytes, align_val_t(align));
+        }
+        void* ptr = malloc(bytes);
+        if (ptr == nullptr) throw bad_alloc();
+        return ptr;
+    }
+
+    static void deallocate(void* ptr, size_t, size_t align) noexcept {
+        if (ptr == nullptr) return;
+        if (align > alignof(max_align_t)) {
+            ::operator delete(ptr, align_val_t(align));
+        } else {
+            free(ptr);
+        }
+    }
+
+    // Только для align <= alignof(max_align_t)
+    static void* reallocate(void* ptr, size_t, size_t newBytes, size_t) {
+        void* result = realloc(ptr, newBytes);
+        if (result == nullptr) throw bad_alloc();
+        return result;
+    }
+};
+
+// Арена: память выдаётся сдвигом указателя в больших блоках и возвращается
+// вся сразу откатом к отметке. Блоки после отката не освобождаются,
+// а используются повторно, поэтому повторяющиеся запросы не обращаются к malloc
+class Arena {
+ private:
+    struct alignas(alignof(max_align_t)) Chunk {
+        Chunk* next;
+        size_t capacity;
+        size_t used;
+        // Данные идут сразу за заголовком
+        uint8_t* bytes() { return reinterpret_cast<uint8_t*>(this + 1); }
+    };
+
+    Chunk* head;        // Первый блок
+    Chunk* current;     // Блок, из которого идёт выделение
+    size_t chunkSize;
+
+    static Chunk* newChunk(size_t capacity) {
+        void* mem = malloc(sizeof(Chunk) + capacity);
+        if (mem == nullptr) throw bad_alloc();
+        Chunk* chunk = static_cast<Chunk*>(mem);
+        chunk->next = nullptr;
+        chunk->capacity = capacity;
+        chunk->used = 0;
+        return chunk;
+    }
+
+    static size_t alignUp(size_t value, size_t align) {
+        return (value + align - 1) & ~(align - 1);
+    }
+
+ public:
+    // Отметка для отката: блок и заполнение в нём
+    struct Mark {
+        Chunk* chunk;
+        size_t used;
+    };
+
+    explicit Arena(size_t defaultChunkSize = 64 * 1024) : head(nullptr)
+                                                         , current(nullptr)
+                                                         , chunkSize(defaultChunkSize) {}
+
+    ~Arena() {
+        while (head != nullptr) {
+            Chunk* next = head->next;
+            free(head);
+            head = next;
+        }
+    }
+
+    Arena(const Arena&) = delete;
+    auto operator=(const Arena&) -> Arena& = delete;
+
+    void* allocate(size_t bytes, size_t align) {
+        if (align > alignof(max_align_t)) {
+            throw invalid_argument("Arena: alignment is too large");
+        }
+        if (current == nullptr) {
+            head = current = newChunk(chunkSize > bytes ? chunkSize : bytes);
+        }
+        while (true) {
+            // Данные блока выровнены по max_align_t, достаточно выровнять смещение
+            size_t offset = alignUp(current->used, align);
+            if (offset + bytes <= current->capacity) {
+                current->used = offset + bytes;
+                return current->bytes() + offset;
+            }
+            if (current->next == nullptr || current->next->capacity < bytes) {
+                // Новый блок вставляется после текущего, дальние остаются для повторного использования
+                Chunk* chunk = newChunk(chunkSize > bytes ? chunkSize : bytes);
+                chunk->next = current->next;
+                current->next = chunk;
+            }
+            current = current->next;
+            current->used = 0;
+        }
+    }
+
+    [[nodiscard]] auto mark() const -> Mark {
+        return Mark{current, current != nullptr ? current->used : 0};
+    }
+
+    // Откат к отметке: всё, выделенное после неё, считается свободным
+    void rewind(const Mark& m) {
+        if (m.chunk == nullptr) {
+            current = head;
+            if (current != nullptr) current->used = 0;
+        } else {
+            current = m.chunk;
+            current->used = m.used;
+        }
+    }
+
+    // Арена запроса текущего потока или nullptr
+    static Arena*& active() {
+        thread_local Arena* arena = nullptr;
+        return arena;
+    }
+};
+
+// Область действия арены: на время жизни объекта арена становится активной
+// для потока, при выходе выделенное в области освобождается одним откатом.
+// Вложенные области восстанавливают предыдущую активную арену
+class ArenaScope {
+ private:
+    Arena& arena;
+    Arena* previous;
+    Arena::Mark start;
+
+ public:
+    explicit ArenaScope(Arena& a) : arena(a), previous(Arena::active()), start(a.mark()) {
+        Arena::active() = &arena;
+    }
+
+    ~ArenaScope() {
+        arena.rewind(start);
+        Arena::active() = previous;
+    }
+
+    ArenaScope(const ArenaScope&) = delete;
+    auto operator=(const ArenaScope&) -> ArenaScope& = delete;
+};
+
+// Выделение из активной арены потока; без активной арены — из кучи.
+// Перед блоком хранится указатель на арену-источник, чтобы освобождение
+// знало, куда возвращать память. Контейнер с этой политикой не должен
+// пережить область ArenaScope, в которой он выделил память
+struct ArenaAllocator {
+    static constexpr bool CanReallocate = false;
+
+    static size_t headerSize(size_t align) {
+        return align > sizeof(Arena*) ? align : sizeof(Arena*);
+    }
+
+    static void* allocate(size_t bytes, size_t align) {
+        size_t header = headerSize(align);
+        Arena* arena = Arena::active();
+        uint8_t* block = arena != nullptr
+            ? static_cast<uint8_t*>(arena->allocate(header + bytes, align))
+            : static_cast<uint8_t*>(HeapAllocator::allocate(header + bytes, align));
+        memcpy(block + header - sizeof(Arena*), &arena, sizeof(Arena*));
+        return block + header;
+    }
+
+    static void deallocate(void* ptr, size_t bytes, size_t align) noexcept {
+        if (ptr == nullptr) return;
+        size_t header = headerSize(align);
+        uint8_t* block = static_cast<uint8_t*>(ptr) - header;
+        Arena* arena = nullptr;
+        memcpy(&arena, block + header - sizeof(Arena*), sizeof(Arena*));
+        // Память арены возвращается целиком при выходе из области
+        if (arena == nullptr) HeapAllocator::deallocate(block, header + bytes, align);
+    }
+
+    static void* reallocate(void*, size_t, size_t, size_t) {
+        throw logic_error("ArenaAllocator does not support reallocate");
+    }
+};
+
+// Пул блоков фиксированных размеров: классы 16, 32, ..., 4096 байт со списками
+// свободных блоков, нарезанных из пластин по 64 КБ. Крупные запросы идут в кучу.
+// Списки свои у каждого потока: память освобождается в том же потоке, где выделена
+struct PoolAllocator {
+    static constexpr bool CanReallocate = false;
+    static constexpr size_t MinBlock = 16;
+    static constexpr size_t MaxBlock = 4096;
+    static constexpr uint32_t Classes = 9;
+    static constexpr size_t SlabSize = 64 * 1024;
+
+ private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    struct Pools {
+        FreeBlock* freeLists[Classes] = {};
+        void* slabs = nullptr;    // Односвязный список пластин (первое слово — следующая)
+
+        ~Pools() {
+            while (slabs != nullptr) {
+                void* next;
+                memcpy(&next, slabs, sizeof(void*));
+                free(slabs);
+                slabs = next;
+            }
+        }
+
+        // Нарезка новой пластины на блоки класса
+        void refill(uint32_t cls) {
+            size_t block = MinBlock << cls;
+            uint8_t* slab = static_cast<uint8_t*>(malloc(SlabSize));
+            if (slab == nullptr) throw bad_alloc();
+            memcpy(slab, &slabs, sizeof(void*));
+            slabs = slab;
+            // Первый блок занят ссылкой на следующую пластину
+            for (size_t offset = block; offset + block <= SlabSize; offset += block) {
+                FreeBlock* fb = reinterpret_cast<FreeBlock*>(slab + offset);
+                fb->next = freeLists[cls];
+                freeLists[cls] = fb;
+            }
+        }
+    };
+
+    static Pools& pools() {
+        thread_local Pools instance;
+        return instance;
+    }
+
+    static uint32_t classFor(size_t bytes) {
+        uint32_t cls = 0;
+        while ((MinBlock << cls) < bytes) cls++;
+        return cls;
+    }
+
+ public:
+    static void* allocate(size_t bytes, size_t align) {
+        if (bytes > MaxBlock || align > MinBlock) return HeapAllocator::allocate(bytes, align);
+        uint32_t cls = classFor(bytes);
+        Pools& p = pools();
+        if (p.freeLists[cls] == nullptr) p.refill(cls);
+        FreeBlock* block = p.freeLists[cls];
+        p.freeLists[cls] = block->next;
+        return block;
+    }
+
+    static void deallocate(void* ptr, size_t bytes, size_t align) noexcept {
+        if (ptr == nullptr) return;
+        if (bytes > MaxBlock || align > MinBlock) {
+            HeapAllocator::deallocate(ptr, bytes, align);
+            return;
+        }
+        uint32_t cls = classFor(bytes);
+        Pools& p = pools();
+        FreeBlock* block = static_cast<FreeBlock*>(ptr);
+        block->next = p.freeLists[cls];
+        p.freeLists[cls] = block;
+    }
+
+    static void* reallocate(void*, size_t, size_t, size_t) {
+        throw logic_error("PoolAllocator does not support reallocate");
+    }
+};
+
+#endif   // ALLOC_HPP
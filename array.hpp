@@ -8,25 +8,277 @@
 #include <string>
 #include <stdexcept>
 #include <initializer_list>
+#include <utility>
+#include <new>
+#include <type_traits>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <algorithm>
+#include "alloc.hpp"
+#include "textio.hpp"
 
 using namespace std;
 
+// Коэффициент роста ёмкости при добавлении в полный массив
+enum class Growth : uint8_t {
+    Double,       // 2x: меньше перевыделений
+    OneAndHalf    // 1.5x: меньше неиспользуемой памяти у больших массивов
+};
+
+// Бинарный формат массива (MSAVE_BINARY, MappedArray):
+//   [ArrayFileHeader][count × T]
+// Элементы пишутся как есть, поэтому формат доступен только тривиально
+// копируемым T. Данные начинаются со смещения 64, что позволяет отображать
+// файл в память и обращаться к элементам без копирования
+constexpr char ArrayFileMagic[4] = {'A', 'R', 'R', 'B'};
+constexpr uint32_t ArrayFileVersion = 1;
+constexpr uint32_t ArrayFileByteOrder = 0x01020304;
+
+struct ArrayFileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t typeTag;       // ArrayTypeTag<T>: вид и размер элемента
+    uint32_t elementSize;
+    uint32_t elementAlign;
+    uint64_t count;
+    uint64_t checksum;      // arrayChecksum по байтам данных
+    uint64_t dataOffset;
+    uint64_t reserved[2];
+};
+
+static_assert(sizeof(ArrayFileHeader) == 64, "Header layout must stay fixed");
+
+// Метка типа элемента в файле: вид (1 — знаковое целое, 2 — беззнаковое,
+// 3 — вещественное, 4 — перечисление, 0 — прочее) и размер в байтах.
+// Для своих структур метку можно задать специализацией
+template <typename T>
+struct ArrayTypeTag {
+    static constexpr uint32_t kind = is_floating_point_v<T> ? 3
+                                   : is_enum_v<T> ? 4
+                                   : is_integral_v<T> ? (is_signed_v<T> ? 1 : 2)
+                                   : 0;
+    static constexpr uint32_t value = (kind << 24) | static_cast<uint32_t>(sizeof(T));
+};
+
+// Контрольная сумма данных: четыре независимые цепочки по 8 байт,
+// чтобы умножения шли параллельно, затем хвост по байтам
+inline uint64_t arrayChecksum(const void* bytes, size_t length) {
+    constexpr uint64_t prime = 0x9e3779b97f4a7c15ull;
+    const auto* p = static_cast<const uint8_t*>(bytes);
+    uint64_t lanes[4] = {length, prime, ~length, prime ^ length};
+    size_t i = 0;
+    for (; i + 32 <= length; i += 32) {
+        for (uint32_t lane = 0; lane < 4; lane++) {
+            uint64_t word;
+            memcpy(&word, p + i + lane * 8, sizeof(word));
+            lanes[lane] = (lanes[lane] ^ word) * prime;
+            lanes[lane] ^= lanes[lane] >> 29;
+        }
+    }
+    uint64_t h = lanes[0] ^ (lanes[1] * 3) ^ (lanes[2] * 5) ^ (lanes[3] * 7);
+    for (; i < length; i++) {
+        h = (h ^ p[i]) * 0x100000001b3ull;
+    }
+    h ^= h >> 32;
+    return h * prime;
+}
+
+// Встроенный буфер на N элементов для малых массивов; при N = 0 пуст
+// и за счёт наследования не занимает места
+template <typename T, size_t N>
+struct InlineBuffer {
+    alignas(T) unsigned char bytes[N * sizeof(T)];
+    T* inlineData() { return reinterpret_cast<T*>(bytes); }
+    const T* inlineData() const { return reinterpret_cast<const T*>(bytes); }
+};
+
 template <typename T>
-class Array {
+struct InlineBuffer<T, 0> {
+    T* inlineData() { return nullptr; }
+    const T* inlineData() const { return nullptr; }
+};
+
+// Динамический массив. Alloc — политика выделения памяти (alloc.hpp).
+// Размер и ёмкость 64-битные, рост ёмкости проверяется на переполнение.
+// При Inline > 0 первые Inline элементов хранятся в самом объекте и куча
+// не используется, пока массив не вырастет (см. SmallArray)
+template <typename T, typename Alloc = HeapAllocator, size_t Inline = 0>
+class Array : private InlineBuffer<T, Inline> {
+ public:
+    using size_type = uint64_t;
+
  private:
-    uint32_t size;
-    uint32_t capacity;
-    T* data;
+    using InlineBuffer<T, Inline>::inlineData;
+
+    size_type size;
+    size_type capacity;
+    Growth growth = Growth::Double;
+    T* data;      // Сырая память на capacity элементов, сконструированы первые size
+
+    // Тривиально копируемые элементы можно переносить побайтно: сдвиги идут
+    // через memmove, а если политика умеет, расширение — через realloc
+    static constexpr bool Relocatable = is_trivially_copyable_v<T> && alignof(T) <= alignof(max_align_t);
+
+    static constexpr bool NothrowMove = Inline == 0 || is_nothrow_move_constructible_v<T>;
+
+    static T* allocate(size_type count) {
+        if (count == 0) return nullptr;
+        return static_cast<T*>(Alloc::allocate(sizeof(T) * static_cast<size_t>(count), alignof(T)));
+    }
+
+    // Размер нужен политикам без заголовков блоков (пул)
+    static void deallocate(T* ptr, size_type count) noexcept {
+        if (ptr == nullptr) return;
+        Alloc::deallocate(ptr, sizeof(T) * static_cast<size_t>(count), alignof(T));
+    }
+
+    static void destroy(T* first, T* last) noexcept {
+        if constexpr (!is_trivially_destructible_v<T>) {
+            for (; first != last; ++first) first->~T();
+        }
+    }
+
+    [[nodiscard]] auto isInline() const -> bool {
+        return Inline > 0 && data == inlineData();
+    }
+
+    // Память под cap элементов: встроенный буфер, если хватает, иначе из политики
+    void initStorage(size_type cap) {
+        if (Inline > 0 && cap <= Inline) {
+            data = inlineData();
+            capacity = Inline;
+        } else {
+            data = allocate(cap);
+            capacity = cap;
+        }
+    }
+
+    // Освобождение памяти (элементы уже разрушены)
+    void releaseStorage() noexcept {
+        if (!isInline()) deallocate(data, capacity);
+    }
+
+    // Перенос элементов в новую память: перемещение, если оно не бросает, иначе копирование
+    static void relocate(T* from, size_type count, T* to) {
+        size_type i = 0;
+        try {
+            for (; i < count; i++) {
+                new (to + i) T(move_if_noexcept(from[i]));
+            }
+        } catch (...) {
+            destroy(to, to + i);
+            throw;
+        }
+    }
+
+    // Перевыделение памяти под newCapacity элементов (newCapacity >= size).
+    // Ёмкость, помещающаяся во встроенный буфер, возвращает элементы в него
+    void reallocate(size_type newCapacity) {
+        bool toInline = Inline > 0 && newCapacity <= Inline;
+        if (toInline && isInline()) return;
+        if constexpr (Relocatable && Alloc::CanReallocate) {
+            if (!toInline && !isInline() && data != nullptr && newCapacity != 0) {
+                data = static_cast<T*>(Alloc::reallocate(data, sizeof(T) * static_cast<size_t>(capacity),
+                                                         sizeof(T) * static_cast<size_t>(newCapacity), alignof(T)));
+                capacity = newCapacity;
+                return;
+            }
+        }
+        T* newData = toInline ? inlineData() : allocate(newCapacity);
+        if constexpr (Relocatable) {
+            if (size > 0) memcpy(static_cast<void*>(newData), data, sizeof(T) * size);
+        } else {
+            try {
+                relocate(data, size, newData);
+            } catch (...) {
+                if (!toInline) deallocate(newData, newCapacity);
+                throw;
+            }
+            destroy(data, data + size);
+        }
+        releaseStorage();
+        data = newData;
+        capacity = toInline ? Inline : newCapacity;
+    }
+
+    // Наибольшее число элементов, чей размер в байтах помещается в size_t и ptrdiff_t
+    static constexpr size_type maxElements() {
+        return static_cast<size_type>(PTRDIFF_MAX) / sizeof(T);
+    }
+
+    // Ёмкость, нужная для minCapacity элементов, с учётом коэффициента роста
+    [[nodiscard]] auto grownCapacity(size_type minCapacity) const -> size_type {
+        if (minCapacity > maxElements()) throw length_error("Error: Array size is too large");
+        size_type step = growth == Growth::Double ? capacity : capacity / 2;
+        size_type grown = capacity > maxElements() - step ? maxElements() : capacity + step;
+        if (grown < minCapacity) grown = minCapacity;
+        return grown == 0 ? 1 : grown;
+    }
+
+    [[nodiscard]] auto grownCapacity() const -> size_type {
+        if (capacity == maxElements()) throw length_error("Error: Array size is too large");
+        return grownCapacity(capacity + 1);
+    }
 
     void doubleArray() {  // Удвоение массива при достижении лимита capacity
-        uint32_t cap = capacity == 0 ? 1 : capacity; // Защита если capacity вдруг 0
-        T* newData = new T[cap * 2];
-        capacity = cap * 2;
-        for (uint32_t i = 0; i < size; i++) {
-            newData[i] = data[i];
+        reallocate(grownCapacity());
+    }
+
+    // Вставка в конец с расширением. Новый элемент конструируется до переноса старых:
+    // args может ссылаться на элемент этого же массива
+    template <typename... Args>
+    T& growAndEmplace(Args&&... args) {
+        if constexpr (Relocatable) {
+            T value(std::forward<Args>(args)...);  // До realloc: args может указывать в data
+            reallocate(grownCapacity());
+            new (data + size) T(value);
+            return data[size++];
+        }
+        size_type newCapacity = grownCapacity();
+        T* newData = allocate(newCapacity);
+        try {
+            new (newData + size) T(std::forward<Args>(args)...);
+        } catch (...) {
+            deallocate(newData, newCapacity);
+            throw;
+        }
+        try {
+            relocate(data, size, newData);
+        } catch (...) {
+            newData[size].~T();
+            deallocate(newData, newCapacity);
+            throw;
         }
-        delete[] data;
+        destroy(data, data + size);
+        releaseStorage();
         data = newData;
+        capacity = newCapacity;
+        return data[size++];
+    }
+
+    // Забирает содержимое other: память из кучи передаётся, встроенные элементы перемещаются
+    void takeFrom(Array& other) noexcept(NothrowMove) {
+        growth = other.growth;
+        if (other.isInline()) {
+            data = inlineData();
+            capacity = Inline;
+            for (size = 0; size < other.size; size++) {
+                new (data + size) T(std::move(other.data[size]));
+            }
+            other.clear();
+        } else {
+            size = other.size;
+            capacity = other.capacity;
+            data = other.data;
+            other.size = 0;
+            other.capacity = Inline;
+            other.data = other.inlineData();
+        }
     }
 
  public:
@@ -38,58 +290,100 @@ class Array {
     const_iterator begin() const { return data; }
     const_iterator end() const { return data + size; }
 
-    Array() : size(0)  // Конструктор для пустого массива
-            , capacity(1)
-            , data(new T[1]) {}
+    // Конструктор для пустого массива: память не выделяется до первой вставки
+    Array() : size(0)
+            , capacity(Inline)
+            , data(inlineData()) {}
 
     // Конструктор для списка инициализации
-    Array(std::initializer_list<T> init) : size(init.size())
-                                        , capacity(init.size())
-                                        , data(new T[init.size()]) {
-        uint32_t i = 0;
-        for (const auto& item : init) {
-            data[i++] = item;
+    Array(std::initializer_list<T> init) : size(0) {
+        initStorage(static_cast<size_type>(init.size()));
+        try {
+            for (const auto& item : init) {
+                new (data + size) T(item);
+                size++;
+            }
+        } catch (...) {
+            destroy(data, data + size);
+            releaseStorage();
+            throw;
         }
     }
 
-    explicit Array(const uint32_t cap) : size(cap > 0 ? cap - 1 : 0)
-                                        , capacity(cap > 0 ? cap : 1)
-                                        , data(new T[capacity]) {
-        for (uint32_t i = 0; i < size; i++) {
-            data[i] = T();
+    // Массив из cap - 1 элементов T() с ёмкостью cap
+    explicit Array(const size_type cap) : size(0) {
+        initStorage(cap > 0 ? cap : 1);
+        try {
+            for (size_type count = cap > 0 ? cap - 1 : 0; size < count; size++) {
+                new (data + size) T();
+            }
+        } catch (...) {
+            destroy(data, data + size);
+            releaseStorage();
+            throw;
         }
     }
 
     ~Array() {  // Деструктор
-        delete[] data;
+        destroy(data, data + size);
+        releaseStorage();
     }
 
-    Array(const Array<T>& other) : size(other.size)  // Копирующий конструктор
-                                    , capacity(other.capacity)
-                                    , data(new T[other.capacity]) {
-        for (uint32_t i = 0; i < size; i++) {
-            data[i] = other.data[i];
+    Array(const Array& other) : size(0)  // Копирующий конструктор
+                              , growth(other.growth) {
+        initStorage(other.capacity);
+        try {
+            for (; size < other.size; size++) {
+                new (data + size) T(other.data[size]);
+            }
+        } catch (...) {
+            destroy(data, data + size);
+            releaseStorage();
+            throw;
         }
     }
 
+    // Перемещающий конструктор: забирает память, other остаётся пустым
+    Array(Array&& other) noexcept(NothrowMove) {
+        takeFrom(other);
+    }
+
     // Копирующий оператор присваивания
-    auto operator=(const Array<T>& other) -> Array<T>& {
+    auto operator=(const Array& other) -> Array& {
         if (this == &other) {  // Защита от a = a
             return *this;
         }
-        delete[] data;
+        Array copy(other);
+        swap(copy);
+        return *this;
+    }
 
-        capacity = other.capacity;
-        size = other.size;
-        data = new T[capacity];
-        for (uint32_t i = 0; i < size; i++) {
-            data[i] = other.data[i];
+    // Перемещающий оператор присваивания
+    auto operator=(Array&& other) noexcept(NothrowMove) -> Array& {
+        if (this != &other) {
+            destroy(data, data + size);
+            releaseStorage();
+            takeFrom(other);
         }
         return *this;
     }
 
+    // Обмен содержимым с другим массивом. Без встроенных элементов — без копирования
+    void swap(Array& other) noexcept(NothrowMove) {
+        if (!isInline() && !other.isInline()) {
+            std::swap(size, other.size);
+            std::swap(capacity, other.capacity);
+            std::swap(growth, other.growth);
+            std::swap(data, other.data);
+            return;
+        }
+        Array tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
     // Неконстантная перегрузка оператора скобок
-    auto operator[](uint32_t index) -> T& {
+    auto operator[](size_type index) -> T& {
         if (index >= size) {
             throw out_of_range("Error: Index " + to_string(index) 
             + " is out of bounds (size " + to_string(size) + ").");
@@ -98,7 +392,7 @@ class Array {
     }
 
     // Константная перегрузка оператора скобок (для чтения)
-    auto operator[](uint32_t index) const -> const T& {
+    auto operator[](size_type index) const -> const T& {
         if (index >= size) {
             throw out_of_range("Error: Index " + to_string(index) 
             + " is out of bounds (size " + to_string(size) + ").");
@@ -107,7 +401,37 @@ class Array {
     }
 
     void push_back(const T& value) {
-        MPUSH_BACK(value);
+        emplace_back(value);
+    }
+
+    void push_back(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    // Конструирование элемента прямо в конце массива
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size == capacity) {
+            return growAndEmplace(std::forward<Args>(args)...);
+        }
+        new (data + size) T(std::forward<Args>(args)...);
+        return data[size++];
+    }
+
+    // Ёмкость не меньше n; элементы переносятся один раз
+    void reserve(size_type n) {
+        if (n > maxElements()) throw length_error("Error: Array size is too large");
+        if (n > capacity) reallocate(n);
+    }
+
+    // Выбор коэффициента роста для этого массива
+    void setGrowth(Growth policy) {
+        growth = policy;
+    }
+
+    // Освобождение неиспользуемой ёмкости
+    void shrink_to_fit() {
+        if (capacity > size) reallocate(size);
     }
 
     bool empty() const {
@@ -124,37 +448,127 @@ class Array {
         return data[size - 1];
     }
 
-    // Очистка массива но сохранение capacity
+    // Очистка массива (элементы разрушаются) но сохранение capacity
     void clear() {
-        size = 0; 
+        destroy(data, data + size);
+        size = 0;
     }
 
-    void MPUSH_BACK(T value) {  // Добавление элемента в конец массива
+    void MPUSH_BACK(const T& value) {  // Добавление элемента в конец массива
+        emplace_back(value);
+    }
+
+    void MPUSH_BACK(T&& value) {
+        emplace_back(std::move(value));
+    }
+
+    // Добавление элемента по индексу. value принимается по значению и перемещается,
+    // поэтому может быть копией элемента этого же массива
+    void MPUSH_BY_IND(size_type index, T value) {
+        if (index > size) {
+            throw out_of_range("Error: Index " + to_string(index) + " is out of bounds for insertion.");
+        }
+        if (index == size) {
+            emplace_back(std::move(value));
+            return;
+        }
         if (size + 1 > capacity) {
             doubleArray();
         }
-        data[size] = value;
+        if constexpr (Relocatable) {
+            memmove(static_cast<void*>(data + index + 1), data + index, sizeof(T) * (size - index));
+            new (data + index) T(std::move(value));
+            size++;
+            return;
+        }
+        new (data + size) T(std::move(data[size - 1]));
         size++;
+        for (size_type j = size - 2; j > index; j--) {
+            data[j] = std::move(data[j - 1]);
+        }
+        data[index] = std::move(value);
     }
 
-    // Добавление элемента по индексу
-    void MPUSH_BY_IND(uint32_t index, T value) {
-        if (size + 1 > capacity) {
-            doubleArray();
+    // Вставка диапазона [first, last) перед позицией index за один сдвиг хвоста.
+    // Однопроходный диапазон (поток) дописывается в конец и поворачивается на место.
+    // Диапазон не должен указывать внутрь этого массива
+    template <typename InputIt>
+    void insert_range(size_type index, InputIt first, InputIt last) {
+        if (index > size) {
+            throw out_of_range("Error: Index " + to_string(index) + " is out of bounds for insertion.");
         }
-        if (index <= size) {
-            for (uint32_t j = size; j > index; j--) {
-                data[j] = data[j - 1];
-            }
-            data[index] = value;
-            size++;
+        using Category = typename iterator_traits<InputIt>::iterator_category;
+        if constexpr (!is_base_of_v<forward_iterator_tag, Category>) {
+            size_type oldSize = size;
+            for (; first != last; ++first) emplace_back(*first);
+            std::rotate(data + index, data + oldSize, data + size);
+            return;
+        }
+        auto distance = std::distance(first, last);
+        if (distance <= 0) return;
+        if (static_cast<size_type>(distance) > maxElements() - size) {
+            throw length_error("Error: Array size is too large");
+        }
+        size_type count = static_cast<size_type>(distance);
+        if (size + count > capacity) {
+            reallocate(grownCapacity(size + count));
+        }
+
+        size_type tail = size - index;
+        if constexpr (Relocatable) {
+            memmove(static_cast<void*>(data + index + count), data + index, sizeof(T) * tail);
+            uninitialized_copy(first, last, data + index);
+        } else if (count <= tail) {
+            // Последние count элементов переезжают в неинициализированную память,
+            // остаток хвоста сдвигается присваиванием, диапазон присваивается на место
+            uninitialized_move(data + size - count, data + size, data + size);
+            move_backward(data + index, data + size - count, data + size);
+            copy(first, last, data + index);
         } else {
-            throw out_of_range("Error: Index " + to_string(index) + " is out of bounds for insertion.");
+            // Хвост короче диапазона: часть диапазона сразу конструируется за концом
+            InputIt middle = first;
+            std::advance(middle, tail);
+            uninitialized_copy(middle, last, data + size);
+            uninitialized_move(data + index, data + size, data + index + count);
+            copy(first, middle, data + index);
+        }
+        size += count;
+    }
+
+    // Удаление элементов [from, to) одним сдвигом хвоста
+    void erase_range(size_type from, size_type to) {
+        if (from > to || to > size) {
+            throw out_of_range("Error: Range [" + to_string(from) + ", " + to_string(to)
+                               + ") is out of bounds for deletion.");
         }
+        if (from == to) return;
+        if constexpr (Relocatable) {
+            memmove(static_cast<void*>(data + from), data + to, sizeof(T) * (size - to));
+        } else {
+            std::move(data + to, data + size, data + from);
+            destroy(data + size - (to - from), data + size);
+        }
+        size -= to - from;
+    }
+
+    // Удаление всех элементов, для которых pred истинен, за один проход.
+    // Порядок оставшихся сохраняется. Возвращает число удалённых
+    template <typename Pred>
+    size_type erase_if(Pred pred) {
+        size_type kept = 0;
+        for (size_type i = 0; i < size; i++) {
+            if (pred(static_cast<const T&>(data[i]))) continue;
+            if (kept != i) data[kept] = std::move(data[i]);
+            kept++;
+        }
+        size_type removed = size - kept;
+        destroy(data + kept, data + size);
+        size = kept;
+        return removed;
     }
 
     // Получение элемента по индексу
-    auto MGET_BY_IND(uint32_t index) const -> T& {
+    auto MGET_BY_IND(size_type index) const -> T& {
         if (index < size) {
             return data[index];
         } else {
@@ -162,41 +576,37 @@ class Array {
         }
     }
 
-    void MDEL_BY_IND(uint32_t index) {
+    void MDEL_BY_IND(size_type index) {
         if (index < size) {
-            for (uint32_t i = index; i < size - 1; i++) {
-                data[i] = data[i + 1];
-            }
-            size--;
+            erase_range(index, index + 1);
         } else {
             throw out_of_range("Error: Index " + to_string(index) + " is out of bounds for deletion.");
         }
     }
 
-    void MSWAP_BY_IND(uint32_t index, T value) {
+    void MSWAP_BY_IND(size_type index, T value) {
         if (index < size) {
-            data[index] = value;
+            data[index] = std::move(value);
         } else {
             throw out_of_range("Error: Index " + to_string(index) + " is out of bounds for swap.");
         }
     }
 
     void PRINT() const {
-        for (uint32_t i = 0; i < size; i++) {
+        for (size_type i = 0; i < size; i++) {
             cout << data[i] << " ";
         }
         cout << endl;
     }
 
-    // Сохранение массива в файл
+    // Сохранение массива в файл: размер, затем элементы через пробел
     void MSAVE(const string& filename) const {
-        ofstream file(filename);
-        if (!file.is_open()) {
-            throw runtime_error("Error: Unable to open file for writing: " + filename);
-        }
-        file << size << endl;
-        for (uint32_t i = 0; i < size; i++) {
-            file << data[i] << " ";
+        TextWriter file(filename);
+        file.value(size);
+        file.put('\n');
+        for (size_type i = 0; i < size; i++) {
+            file.value(data[i]);
+            file.put(' ');
         }
         file.close();
         cout << "Массив сохранён в файл: " << filename << endl;
@@ -204,107 +614,164 @@ class Array {
 
     // Загрузка массива из файла
     void MLOAD(const string& filename) {
-        ifstream file(filename);
-        if (!file.is_open()) {
-            throw runtime_error("Error: Unable to open file for reading: " + filename);
-        }
-        uint32_t NewSize;
-        if (!(file >> NewSize)) {
+        TextReader file(filename);
+        size_type NewSize;
+        if (!file.value(NewSize)) {
              throw runtime_error("Error: Failed to read size from file: " + filename);
         }
         
-        size = 0;
+        clear();
+        // Размер из файла не проверен: каждое значение занимает минимум 2 байта
+        // (символ и пробел), поэтому резерв не больше того, что может поместиться в остатке
+        uint64_t fits = file.remaining() / 2 + 1;
+        reserve(NewSize < fits ? NewSize : fits);
         T value;
-        while (size < NewSize && file >> value) {
-            MPUSH_BACK(value);
+        while (size < NewSize && file.value(value)) {
+            emplace_back(std::move(value));
         }
 
         if (size != NewSize) {
             throw runtime_error("Error: File corrupted or incomplete data.");
         }
 
-        file.close();
         cout << "Массив загружен из файла: " << filename << endl;
     }
 
-    // Сохранение массива в бинарный файл
+    // Сохранение в бинарный файл формата ArrayFileHeader
     void MSAVE_BINARY(const string& filename) const {
+        static_assert(is_trivially_copyable_v<T>, "Binary array files require a trivially copyable T");
         ofstream file(filename, ios::binary);
         if (!file.is_open()) {
             throw runtime_error("Error: Unable to open file for binary writing: " + filename);
         }
 
-        // Записываем размер массива
-        file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        ArrayFileHeader header{};
+        memcpy(header.magic, ArrayFileMagic, sizeof(header.magic));
+        header.version = ArrayFileVersion;
+        header.byteOrder = ArrayFileByteOrder;
+        header.typeTag = ArrayTypeTag<T>::value;
+        header.elementSize = sizeof(T);
+        header.elementAlign = alignof(T);
+        header.count = size;
+        header.checksum = arrayChecksum(data, sizeof(T) * size);
+        header.dataOffset = sizeof(ArrayFileHeader);
+        file.write(reinterpret_cast<const char*>(&header), sizeof(header));
 
         if (size > 0) {
-            file.write(reinterpret_cast<const char*>(data), size * sizeof(T));
+            file.write(reinterpret_cast<const char*>(data), static_cast<streamsize>(size * sizeof(T)));
         }
         
         if (!file) {
              throw runtime_error("Error: Write operation failed for file: " + filename);
         }
-
-        file.close();
-        cout << "Массив (бинарный) сохранён в файл: " << filename << endl;
     }
 
-    // Загрузка массива из бинарного файла
+    // Загрузка из бинарного файла. Заголовок сверяется с типом T,
+    // данные — с контрольной суммой. Файлы прежнего формата
+    // (32-битный размер и данные без заголовка) читаются как раньше
     void MLOAD_BINARY(const string& filename) {
-        ifstream file(filename, ios::binary);
+        static_assert(is_trivially_copyable_v<T>, "Binary array files require a trivially copyable T");
+        ifstream file(filename, ios::binary | ios::ate);
         if (!file.is_open()) {
              throw runtime_error("Error: Unable to open file for binary reading: " + filename);
         }
+        const uint64_t fileSize = static_cast<uint64_t>(file.tellg());
+        file.seekg(0);
 
-        uint32_t newSize = 0;
-        // Читаем размер массива
-        file.read(reinterpret_cast<char*>(&newSize), sizeof(newSize));
-
-        if (!file) { 
+        ArrayFileHeader header{};
+        uint64_t count = 0;
+        uint64_t offset = 0;
+        file.read(header.magic, sizeof(header.magic));
+        if (!file) {
             throw runtime_error("Error: Failed to read size from binary file.");
         }
+        if (memcmp(header.magic, ArrayFileMagic, sizeof(header.magic)) == 0) {
+            file.seekg(0);
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+            if (!file) {
+                throw runtime_error("Error: Failed to read header from binary file: " + filename);
+            }
+            checkBinaryHeader(header, fileSize, filename);
+            count = header.count;
+            offset = header.dataOffset;
+        } else {
+            uint32_t legacySize;  // Прежний формат: 32-битный размер без заголовка
+            memcpy(&legacySize, header.magic, sizeof(legacySize));
+            count = legacySize;
+            offset = sizeof(legacySize);
+            if (count > (fileSize - offset) / sizeof(T)) {
+                throw runtime_error("Error: Failed to read data from binary file (incomplete file).");
+            }
+        }
 
         // Подготовка памяти
-        if (newSize > capacity) {
-            delete[] data;
-            capacity = newSize; 
-            data = new T[capacity];
-        }
-        size = newSize;
+        clear();
+        reserve(count);
 
         // Читаем данные прямо в массив
-        if (size > 0) {
-            file.read(reinterpret_cast<char*>(data), size * sizeof(T));
+        if (count > 0) {
+            file.seekg(static_cast<streamoff>(offset));
+            file.read(reinterpret_cast<char*>(data), static_cast<streamsize>(count * sizeof(T)));
             if (!file) {
                  throw runtime_error("Error: Failed to read data from binary file (incomplete file).");
             }
         }
+        if (offset == sizeof(ArrayFileHeader) && arrayChecksum(data, sizeof(T) * count) != header.checksum) {
+            throw runtime_error("Error: Checksum mismatch in binary file: " + filename);
+        }
+        size = count;
+    }
 
-        file.close();
-        cout << "Массив (бинарный) загружен из файла: " << filename << endl;
+    // Проверка заголовка бинарного файла на соответствие типу T и размеру файла
+    static void checkBinaryHeader(const ArrayFileHeader& header, uint64_t fileSize, const string& filename) {
+        if (header.version != ArrayFileVersion || header.byteOrder != ArrayFileByteOrder) {
+            throw runtime_error("Error: Unsupported binary array version or byte order: " + filename);
+        }
+        if (header.typeTag != ArrayTypeTag<T>::value || header.elementSize != sizeof(T)
+            || header.elementAlign != alignof(T)) {
+            throw runtime_error("Error: Element type does not match binary array file: " + filename);
+        }
+        if (header.dataOffset != sizeof(ArrayFileHeader) || header.dataOffset > fileSize
+            || header.count > (fileSize - header.dataOffset) / sizeof(T) || header.count > maxElements()) {
+            throw runtime_error("Error: Corrupted binary array header: " + filename);
+        }
     }
 
-    [[nodiscard]] auto GetSize() const -> uint32_t {
+    [[nodiscard]] auto GetSize() const -> size_type {
         return size;
     }
 
-    [[nodiscard]] auto GetCapacity() const -> uint32_t {
+    [[nodiscard]] auto GetCapacity() const -> size_type {
         return capacity;
     }
 
-    void SetSize(uint32_t newSize) {
+    // Новые элементы конструируются как T(), лишние разрушаются
+    void SetSize(size_type newSize) {
         if (newSize > capacity) {
              throw length_error("Error: New size exceeds current capacity.");
         }
+        for (; size < newSize; size++) {
+            new (data + size) T();
+        }
+        destroy(data + newSize, data + size);
         size = newSize;
     }
 
-    void SetCapacity(uint32_t newCapacity) {
+    // Перевыделение памяти ровно под newCapacity элементов
+    void SetCapacity(size_type newCapacity) {
         if (newCapacity < size) {
             throw length_error("Error: New capacity cannot be smaller than current size.");
         }
-        capacity = newCapacity;
+        if (newCapacity != capacity) reallocate(newCapacity);
     }
 };
 
+// Временный массив из арены текущего запроса (см. ArenaScope в alloc.hpp)
+template <typename T>
+using ArenaArray = Array<T, ArenaAllocator>;
+
+// Массив, хранящий до N элементов без обращения к куче
+template <typename T, size_t N, typename Alloc = HeapAllocator>
+using SmallArray = Array<T, Alloc, N>;
+
 #endif   // ARRAY_HPP
\ No newline at end of file
@@ -0,0 +1,202 @@
+#ifndef CDH_HPP
+#define CDH_HPP
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <optional>
+#include <utility>
+#include "dh.hpp"
+
+using namespace std;
+
+// Потокобезопасная хэш-таблица поверх BasicDoubleHash.
+// Ключи распределяются по Shards сегментам по старшим битам хэша. Каждый сегмент
+// хранит неизменяемый снимок таблицы (shared_ptr): чтение атомарно берёт снимок
+// и ищет в нём без блокировок, запись под мьютексом сегмента копирует снимок,
+// меняет копию и публикует её (RCU). Старый снимок живёт, пока его читают.
+// Запись стоит O(размер сегмента), поэтому структура рассчитана на редкие записи
+// и частые чтения: реестр коллекций, индексы при параллельных сканированиях
+template <typename K, typename V, typename Hash = DefaultHash<K>, typename Eq = equal_to<>,
+          uint32_t Shards = 16>
+class ConcurrentDoubleHash {
+    static_assert(Shards > 0 && (Shards & (Shards - 1)) == 0, "Shards must be a power of two");
+
+ public:
+    using Table = BasicDoubleHash<K, V, Hash, Eq>;
+
+ private:
+    using LookupKey = typename HashLookup<K>::type;
+
+    // Сегменты выровнены по кэш-линии, чтобы мьютексы соседей не делили линию.
+    // Снимки неизменяемы, поэтому поиски читателей считаются в атомарных
+    // счётчиках сегмента, а не в самой таблице
+    struct alignas(64) Shard {
+        mutex writeLock;
+        shared_ptr<const Table> snapshot;
+        mutable atomic<uint64_t> findProbes[HashStats::Buckets] = {};
+        mutable atomic<uint32_t> maxFindProbe{0};
+    };
+
+    Shard shards[Shards];
+    atomic<uint32_t> elementsCount;
+    atomic<bool> collectStats{false};
+    Hash hasher;
+
+    // Старшие биты хэша: младшие использует сама таблица для индекса и шага
+    Shard& shardFor(LookupKey key) {
+        return shards[Shards == 1 ? 0 : hasher(key) >> (64 - shardBits())];
+    }
+
+    const Shard& shardFor(LookupKey key) const {
+        return shards[Shards == 1 ? 0 : hasher(key) >> (64 - shardBits())];
+    }
+
+    static constexpr uint32_t shardBits() {
+        uint32_t bits = 0;
+        while ((1u << bits) < Shards) bits++;
+        return bits;
+    }
+
+    static shared_ptr<const Table> load(const Shard& shard) {
+        return atomic_load(&shard.snapshot);
+    }
+
+    shared_ptr<const Table> emptyTable() const {
+        auto table = make_shared<Table>(3, hasher);
+        table->setStatsEnabled(collectStats.load(memory_order_relaxed));
+        return table;
+    }
+
+    // Поиск читателя с учётом пробирований, если статистика включена
+    const V* lookup(const Shard& shard, const Table& table, LookupKey key) const {
+        if (!collectStats.load(memory_order_relaxed)) return table.get(key);
+        uint32_t probes = 0;
+        const V* value = table.get(key, &probes);
+        shard.findProbes[HashStats::bucketFor(probes)].fetch_add(1, memory_order_relaxed);
+        uint32_t seen = shard.maxFindProbe.load(memory_order_relaxed);
+        while (probes > seen && !shard.maxFindProbe.compare_exchange_weak(seen, probes, memory_order_relaxed)) {
+        }
+        return value;
+    }
+
+    // Копирование текущего снимка, изменение копии и публикация.
+    // Возвращается результат modify
+    template <typename F>
+    auto update(Shard& shard, F&& modify) {
+        lock_guard<mutex> guard(shard.writeLock);
+        auto next = make_shared<Table>(*shard.snapshot);
+        auto result = modify(*next);
+        atomic_store(&shard.snapshot, shared_ptr<const Table>(std::move(next)));
+        return result;
+    }
+
+ public:
+    explicit ConcurrentDoubleHash(const Hash& hashFunc = Hash()) : elementsCount(0), hasher(hashFunc) {
+        for (Shard& shard : shards) {
+            shard.snapshot = emptyTable();
+        }
+    }
+
+    ConcurrentDoubleHash(const ConcurrentDoubleHash&) = delete;
+    auto operator=(const ConcurrentDoubleHash&) -> ConcurrentDoubleHash& = delete;
+
+    // Вставка элемента; если ключ уже есть, значение обновляется
+    void insert(const K& key, const V& value) {
+        bool inserted = update(shardFor(key), [&](Table& t) {
+            return t.insert_or_assign(key, value).second;
+        });
+        if (inserted) elementsCount.fetch_add(1, memory_order_relaxed);
+    }
+
+    // Вставка, только если ключа ещё нет. Возвращает true, если элемент вставлен
+    auto try_emplace(const K& key, const V& value) -> bool {
+        Shard& shard = shardFor(key);
+        if (load(shard)->get(key)) return false;  // Быстрый путь без копирования сегмента
+        bool inserted = update(shard, [&](Table& t) {
+            return t.try_emplace(key, value).second;
+        });
+        if (inserted) elementsCount.fetch_add(1, memory_order_relaxed);
+        return inserted;
+    }
+
+    // Поиск без блокировок. Возвращается копия значения: ссылка в снимок
+    // могла бы пережить его замену
+    auto find(LookupKey key) const -> optional<V> {
+        const Shard& shard = shardFor(key);
+        shared_ptr<const Table> snap = load(shard);
+        if (const V* value = lookup(shard, *snap, key)) return *value;
+        return nullopt;
+    }
+
+    auto contains(LookupKey key) const -> bool {
+        const Shard& shard = shardFor(key);
+        return lookup(shard, *load(shard), key) != nullptr;
+    }
+
+    auto remove(LookupKey key) -> bool {
+        Shard& shard = shardFor(key);
+        if (!load(shard)->get(key)) return false;
+        bool removed = update(shard, [&](Table& t) { return t.remove(key); });
+        if (removed) elementsCount.fetch_sub(1, memory_order_relaxed);
+        return removed;
+    }
+
+    // Обход всех элементов: f(key, value). Каждый сегмент обходится по своему
+    // снимку, записи во время обхода видны или не видны целиком по сегменту
+    template <typename F>
+    void forEach(F&& f) const {
+        for (const Shard& shard : shards) {
+            load(shard)->forEach(f);
+        }
+    }
+
+    [[nodiscard]] auto size() const -> uint32_t {
+        return elementsCount.load(memory_order_relaxed);
+    }
+
+    // Суммарная статистика по снимкам всех сегментов и поискам читателей
+    [[nodiscard]] auto stats() const -> HashStats {
+        HashStats result;
+        for (const Shard& shard : shards) {
+            result.merge(load(shard)->stats());
+            for (uint32_t i = 0; i < HashStats::Buckets; i++) {
+                result.findProbes[i] += shard.findProbes[i].load(memory_order_relaxed);
+            }
+            uint32_t maxFind = shard.maxFindProbe.load(memory_order_relaxed);
+            if (maxFind > result.maxProbe) result.maxProbe = maxFind;
+        }
+        return result;
+    }
+
+    // Статистика выключена по умолчанию: поиск читателя без неё не пишет в общую память
+    void setStatsEnabled(bool enabled) {
+        collectStats.store(enabled, memory_order_relaxed);
+        for (Shard& shard : shards) {
+            update(shard, [enabled](Table& t) {
+                t.setStatsEnabled(enabled);
+                return true;
+            });
+        }
+    }
+
+    [[nodiscard]] auto empty() const -> bool {
+        return size() == 0;
+    }
+
+    void clear() {
+        for (Shard& shard : shards) {
+            lock_guard<mutex> guard(shard.writeLock);
+            uint32_t removed = shard.snapshot->size();
+            atomic_store(&shard.snapshot, emptyTable());
+            elementsCount.fetch_sub(removed, memory_order_relaxed);
+        }
+    }
+};
+
+// Потокобезопасная таблица со строковыми ключами
+template <typename T, typename Hash = DefaultHash<string>>
+using ConcurrentHash = ConcurrentDoubleHash<string, T, Hash>;
+
+#endif   // CDH_HPP
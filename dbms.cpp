@@ -1,87 +1,155 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <string_view>
 #include <filesystem>
-#include <regex>
 #include <random>
+#include <atomic>
 #include <chrono> // Для генерации ID
-#include <cstdio> // Для sscanf и sprintf
+#include <cstdio> // Для snprintf
+#include <charconv>
+#include <algorithm>
 #include "json.hpp"
 #include "array.hpp"
 #include "dh.hpp"
+#include "cdh.hpp"
 
 // Псевдоним для удобства
 using json = nlohmann::json;
 using namespace std;
-random_device rd;
 
 struct Timestamp {
-    int year, month, day, hour, minute, second;
+    int64_t year;
+    int month, day, hour, minute, second;
+
+    Timestamp() : year(0)
+                , month(0)
+                , day(0)
+                , hour(0)
+                , minute(0)
+                , second(0) {}
 
     // Конструктор из строки
-    Timestamp(const string& ts) : year(0)
-                                , month(0)
-                                , day(0)
-                                , hour(0)
-                                , minute(0)
-                                , second(0) {
-        if (sscanf(ts.c_str(), "%d-%d-%dT%d:%d:%d", &year, &month, &day, &hour, &minute, &second) != 6) { // Если успешно записаны не 6
+    Timestamp(string_view ts) : Timestamp() {
+        if (!parse(ts, *this)) {
             cerr << "Could't parse timestamp data" << endl;
         }
     }
 
+    // Разбор фиксированного формата YYYY-MM-DDTHH:MM:SS за один проход без regex и sscanf.
+    // Проверка цифр и разделителей идёт без ветвлений по всем 19 символам,
+    // поэтому компилятор может векторизовать цикл.
+    // Возвращает true, если формат верен и дата существует
+    static bool parse(string_view ts, Timestamp& out) {
+        static constexpr char layout[] = "dddd-dd-ddTdd:dd:dd";
+        constexpr size_t length = sizeof(layout) - 1;
+        if (ts.size() != length) return false;
+
+        uint8_t digits[length];
+        uint32_t bad = 0;
+        for (size_t i = 0; i < length; i++) {
+            uint8_t c = static_cast<uint8_t>(ts[i]);
+            uint8_t digit = static_cast<uint8_t>(c - '0');
+            uint32_t isDigitPos = layout[i] == 'd';
+            // На позиции цифры ждём 0..9, на остальных — точный разделитель
+            bad |= isDigitPos & (digit > 9);
+            bad |= (isDigitPos ^ 1) & (c != static_cast<uint8_t>(layout[i]));
+            digits[i] = digit;
+        }
+        if (bad) return false;
+
+        out.year = digits[0] * 1000 + digits[1] * 100 + digits[2] * 10 + digits[3];
+        out.month = digits[5] * 10 + digits[6];
+        out.day = digits[8] * 10 + digits[9];
+        out.hour = digits[11] * 10 + digits[12];
+        out.minute = digits[14] * 10 + digits[15];
+        out.second = digits[17] * 10 + digits[18];
+        return out.isValid();
+    }
+
     // Проверка на високосный год
-    bool isLeap(int y) const {
+    bool isLeap(int64_t y) const {
         return (y % 4 == 0 && y % 100 != 0) || (y % 400 == 0);
     }
 
     // Количество дней в месяце
-    int daysInMonth(int m, int y) const {
+    int daysInMonth(int m, int64_t y) const {
         static const int days[] = {0, 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
         if (m == 2 && isLeap(y)) return 29;
         return days[m];
     }
 
-    // Основная логика инкремента
-    void addSeconds(int secToAdd) {
-        second += secToAdd;
+    // Количество дней от 1970-01-01 до заданной даты (пролептический григорианский календарь).
+    // Формула без циклов: год сдвигается так, чтобы февраль был последним месяцем
+    static int64_t daysFromCivil(int64_t y, int m, int d) {
+        y -= m <= 2;
+        const int64_t era = (y >= 0 ? y : y - 399) / 400;
+        const int64_t yoe = y - era * 400;                                     // [0, 399]
+        const int64_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;   // [0, 365]
+        const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;             // [0, 146096]
+        return era * 146097 + doe - 719468;
+    }
 
-        // Нормализация секунд
-        while (second >= 60) {
-            second -= 60;
-            minute++;
-        }
-        // Нормализация минут
-        while (minute >= 60) {
-            minute -= 60;
-            hour++;
+    // Обратное преобразование: дни от 1970-01-01 в год, месяц и день
+    static void civilFromDays(int64_t z, int64_t& y, int& m, int& d) {
+        z += 719468;
+        const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        const int64_t doe = z - era * 146097;                                      // [0, 146096]
+        const int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // [0, 399]
+        const int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);               // [0, 365]
+        const int64_t mp = (5 * doy + 2) / 153;                                    // [0, 11]
+        d = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+        m = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+        y = yoe + era * 400 + (m <= 2);
+    }
+
+    // Секунды от начала эпохи Unix
+    int64_t toEpoch() const {
+        return daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+    }
+
+    static Timestamp fromEpoch(int64_t epoch) {
+        int64_t days = epoch / 86400;
+        int64_t secOfDay = epoch % 86400;
+        if (secOfDay < 0) {  // Округление вниз для дат до 1970 года
+            secOfDay += 86400;
+            days--;
         }
-        // Нормализация часов
-        while (hour >= 24) {
-            hour -= 24;
-            day++;
+        Timestamp t;
+        civilFromDays(days, t.year, t.month, t.day);
+        t.hour = static_cast<int>(secOfDay / 3600);
+        t.minute = static_cast<int>(secOfDay / 60 % 60);
+        t.second = static_cast<int>(secOfDay % 60);
+        return t;
+    }
+
+    // Основная логика инкремента: O(1) через эпоху, поддерживает отрицательные значения.
+    // Результат, который нельзя записать строкой (год вне 0000..9999), отвергается,
+    // и исходное значение не меняется
+    void addSeconds(int64_t secToAdd) {
+        int64_t epoch = toEpoch();
+        if ((secToAdd > 0 && epoch > INT64_MAX - secToAdd) || (secToAdd < 0 && epoch < INT64_MIN - secToAdd)) {
+            throw overflow_error("Timestamp increment is out of range");
         }
+        Timestamp result = fromEpoch(epoch + secToAdd);
+        result.checkYear();
+        *this = result;
+    }
 
-        // Нормализация дней (переход через месяцы и годы)
-        while (true) {
-            int dim = daysInMonth(month, year);
-            if (day <= dim) break; // Если день вписывается в месяц — выходим
-            
-            day -= dim; // Вычитаем дни текущего месяца
-            month++;    // Переходим к следующему
-            
-            if (month > 12) { // Новый год
-                month = 1;
-                year++;
-            }
+    // Формат фиксированный (его читает parse), поэтому год за пределами 0000..9999 не представим
+    void checkYear() const {
+        if (year < 0 || year > 9999) {
+            throw out_of_range("Timestamp year " + to_string(year) + " is out of range 0000-9999");
         }
     }
 
     // Конвертация обратно в строку
     string toString() const {
-        char buffer[25];
+        checkYear();
+        char buffer[48];
         // %02d добавляет ведущий ноль, если число меньше 10
-        sprintf(buffer, "%04d-%02d-%02dT%02d:%02d:%02d", year, month, day, hour, minute, second);
+        snprintf(buffer, sizeof(buffer), "%04lld-%02d-%02dT%02d:%02d:%02d",
+                 static_cast<long long>(year), month, day, hour, minute, second);
         return string(buffer);
     }
     
@@ -96,12 +164,89 @@ struct Timestamp {
     }
 };
 
-// Функция-обертка для валидации в validateDocument
-bool isValidTimestamp(const string& ts) {
-    Timestamp t(ts);
-    // Проверяем формат через паттерн и логическую валидность даты
-    static const regex pattern(R"(^\d{4}-\d{2}-\d{2}T\d{2}:\d{2}:\d{2}$)");
-    return regex_match(ts, pattern) && t.isValid();
+// Идентификатор документа: 128 бит. Строковая форма "hi_lo" совпадает
+// с форматом старых id (наносекунды эпохи + "_" + число)
+struct ObjectId {
+    uint64_t hi;  // Время создания в наносекундах
+    uint64_t lo;  // Номер узла (старшие 32 бита) и счётчик процесса
+
+    bool operator==(const ObjectId& other) const { return hi == other.hi && lo == other.lo; }
+    bool operator!=(const ObjectId& other) const { return !(*this == other); }
+    bool operator<(const ObjectId& other) const {
+        return hi != other.hi ? hi < other.hi : lo < other.lo;
+    }
+
+    string toString() const {
+        return to_string(hi) + "_" + to_string(lo);
+    }
+
+    // Разбор канонической строковой формы (без ведущих нулей), чтобы
+    // у каждого id была ровно одна строка и одна бинарная форма
+    static bool parse(string_view s, ObjectId& out) {
+        size_t sep = s.find('_');
+        if (sep == string_view::npos) return false;
+        return parsePart(s.substr(0, sep), out.hi) && parsePart(s.substr(sep + 1), out.lo);
+    }
+
+    // Компактная бинарная форма: 16 байт big-endian, memcmp совпадает с порядком id
+    void toBinary(uint8_t out[16]) const {
+        for (int i = 0; i < 8; i++) {
+            out[i] = static_cast<uint8_t>(hi >> (56 - 8 * i));
+            out[8 + i] = static_cast<uint8_t>(lo >> (56 - 8 * i));
+        }
+    }
+
+    static bool parsePart(string_view part, uint64_t& value) {
+        if (part.empty() || (part.size() > 1 && part[0] == '0')) return false;
+        auto [end, ec] = from_chars(part.data(), part.data() + part.size(), value);
+        return ec == errc() && end == part.data() + part.size();
+    }
+
+    static ObjectId fromBinary(const uint8_t in[16]) {
+        ObjectId id{0, 0};
+        for (int i = 0; i < 8; i++) {
+            id.hi = (id.hi << 8) | in[i];
+            id.lo = (id.lo << 8) | in[8 + i];
+        }
+        return id;
+    }
+};
+
+// Генератор k-сортируемых id: время строго возрастает внутри процесса,
+// поэтому порядок id совпадает с порядком вставки. Потокобезопасен,
+// random_device читается один раз при старте для номера узла
+class IdGenerator {
+    atomic<uint64_t> lastTime{0};
+    atomic<uint32_t> sequence{0};
+    uint32_t node;
+
+    IdGenerator() : node(random_device{}()) {}
+
+public:
+    static IdGenerator& instance() {
+        static IdGenerator generator;
+        return generator;
+    }
+
+    ObjectId next() {
+        uint64_t now = static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+            chrono::system_clock::now().time_since_epoch()).count());
+        uint64_t prev = lastTime.load(memory_order_relaxed);
+        uint64_t time;
+        do {
+            // Если часы не сдвинулись или ушли назад, продолжаем с предыдущего значения
+            time = now > prev ? now : prev + 1;
+        } while (!lastTime.compare_exchange_weak(prev, time, memory_order_relaxed));
+
+        uint32_t seq = sequence.fetch_add(1, memory_order_relaxed);
+        return ObjectId{time, (static_cast<uint64_t>(node) << 32) | seq};
+    }
+};
+
+// Функция-обертка для валидации в SchemaValidator
+bool isValidTimestamp(string_view ts) {
+    Timestamp t;
+    return Timestamp::parse(ts, t);
 }
 
 // Предварительное объявление
@@ -179,22 +324,165 @@ bool matchDocument(const json& doc, const json& query) {
     return true;
 }
 
+// Тип поля схемы. Имена типов из schema.json сравниваются только при компиляции
+enum class FieldType : uint8_t { Int, String, Timestamp, Object, Any };
+
+// Схема коллекции, скомпилированная в плоскую программу проверки.
+// Вложенный объект — операция Object, за которой идут операции его полей;
+// end указывает на первую операцию после них, чтобы пропустить отсутствующий объект целиком
+class SchemaValidator {
+    struct SchemaOp {
+        string key;
+        FieldType type = FieldType::Any;
+        uint64_t end = 0;  // Индекс в program: Array<SchemaOp>::size_type
+    };
+
+    static constexpr uint32_t MaxDepth = 32;
+    Array<SchemaOp> program;
+    using Pc = Array<SchemaOp>::size_type;
+
+    static FieldType typeFromName(const json& typeVal) {
+        if (typeVal.is_object()) return FieldType::Object;
+        if (!typeVal.is_string()) return FieldType::Any;
+        const string& type = typeVal.get_ref<const string&>();
+        if (type == "int") return FieldType::Int;
+        if (type == "string" || type == "str") return FieldType::String;
+        if (type == "timestamp") return FieldType::Timestamp;
+        return FieldType::Any;  // Неизвестные типы не проверяются
+    }
+
+    void compile(const json& schemaSubset, uint32_t depth) {
+        if (depth >= MaxDepth) {
+            throw length_error("Schema nesting is deeper than " + to_string(MaxDepth) + " levels");
+        }
+        for (auto& [key, typeVal] : schemaSubset.items()) {
+            SchemaOp op;
+            op.key = key;
+            op.type = typeFromName(typeVal);
+            Pc pc = program.GetSize();
+            program.push_back(op);
+            if (op.type == FieldType::Object) {
+                compile(typeVal, depth + 1);
+            }
+            program[pc].end = program.GetSize();
+        }
+    }
+
+    // Обход программы без рекурсии: для каждого поля документа вызывается
+    // visit(op, value). Если visit возвращает false, обход прерывается
+    template <typename Json, typename Visitor>
+    bool run(Json& doc, Visitor&& visit) const {
+        Json* parents[MaxDepth];
+        Pc ends[MaxDepth];
+        uint32_t depth = 0;
+        Json* cur = &doc;
+        Pc pc = 0;
+        const Pc count = program.GetSize();
+
+        while (pc < count) {
+            // Выход из вложенных объектов, поля которых закончились
+            while (depth > 0 && pc == ends[depth - 1]) {
+                cur = parents[--depth];
+            }
+            const SchemaOp& op = program[pc];
+            auto it = cur->find(op.key);
+            if (it == cur->end()) {
+                pc = op.end;
+                continue;
+            }
+            if (!visit(op, *it)) return false;
+            if (op.type == FieldType::Object && it->is_object()) {
+                parents[depth] = cur;
+                ends[depth] = op.end;
+                depth++;
+                cur = &*it;
+                pc++;
+                continue;
+            }
+            pc = op.end;
+        }
+        return true;
+    }
+
+public:
+    explicit SchemaValidator(const json& schema) {
+        compile(schema, 0);
+    }
+
+    bool validate(const json& doc) const {
+        return run(doc, [](const SchemaOp& op, const json& value) {
+            switch (op.type) {
+                case FieldType::Int: return value.is_number_integer();
+                case FieldType::String: return value.is_string();
+                case FieldType::Timestamp:
+                    // Проверяем, что это строка И она соответствует формату
+                    return value.is_string() && isValidTimestamp(value.get_ref<const string&>());
+                case FieldType::Object: return value.is_object();
+                case FieldType::Any: return true;
+            }
+            return true;
+        });
+    }
+
+    // Пакетная проверка для insert_many
+    void validateBatch(const json& documents, Array<bool>& valid) const {
+        valid.clear();
+        for (const auto& doc : documents) {
+            valid.push_back(validate(doc));
+        }
+    }
+
+    // Применяет f ко всем присутствующим в документе полям заданного типа
+    template <typename F>
+    void forEachField(json& doc, FieldType type, F&& f) const {
+        run(doc, [&](const SchemaOp& op, json& value) {
+            if (op.type == type) f(value);
+            return true;
+        });
+    }
+};
+
+// Размер периода для секционирования по времени
+enum class Granularity { Hour, Day, Month, Year };
+
 class Collection {
     string name;
     string path;
     size_t tuples_limit;
     json structure; 
+    SchemaValidator validator;  // Схема, скомпилированная при создании коллекции
+
+    // Секционирование по timestamp-полю: документы раскладываются по каталогам
+    // периодов (path/2024-02-29/N.json), документы без поля остаются в path/N.json
+    string partitionField;  // Пустая строка — секционирование выключено
+    Granularity granularity = Granularity::Day;
+
+    // Индекс _id: отсортированный массив 16-байтных id с номером чанка.
+    // Строковая форма id нужна только на границе с JSON
+    struct IdEntry {
+        ObjectId id{0, 0};
+        uint32_t chunk = 0;  // Номер в chunkPaths или AmbiguousChunk
+    };
+    // Один и тот же _id (заданный пользователем) лежит в нескольких чанках:
+    // поиск по такому id идёт полным просмотром. Отметка не снимается при
+    // удалении дубликатов — это лишь медленнее, но не теряет документы
+    static constexpr uint32_t AmbiguousChunk = UINT32_MAX;
+    Array<IdEntry> idIndex;
+    Array<string> chunkPaths;
+    DoubleHash<uint32_t> chunkRefs;   // Путь чанка -> номер в chunkPaths
+    bool idIndexBuilt = false;
+    bool hasUnindexedIds = false;     // Есть документы с id не в формате ObjectId
 
     string generateId() {
-        mt19937 gen(rd());
-        return to_string(chrono::system_clock::now().time_since_epoch().count()) + "_" + to_string(gen());
+        return IdGenerator::instance().next().toString();
     }
 
-    Array<int> getFileIndexes() {
-        Array<int> indexes;
-        if (!filesystem::exists(path)) return {1};
+    ArenaArray<int> getFileIndexes(const string& dir) {
+        ArenaArray<int> indexes;
+        if (!filesystem::exists(dir)) return {1};
         
-        for (const auto& entry : filesystem::directory_iterator(path)) {
+        for (const auto& entry : filesystem::directory_iterator(dir)) {
+            if (!entry.is_regular_file()) continue;  // Каталоги секций пропускаем
             string fname = entry.path().filename().string();
             if (fname.find(".json") != string::npos) {
                 try {
@@ -209,67 +497,364 @@ class Collection {
         return indexes;
     }
 
-    bool validateDocument(const json& doc, const json& schemaSubset) {
-        for (auto& [key, typeVal] : schemaSubset.items()) {
-            // Проверяем только те поля, которые есть и в документе, и в схеме
-            if (doc.contains(key)) {
-                // Если в схеме это вложенный объект (например, "specs")
-                if (typeVal.is_object()) {
-                    if (!doc[key].is_object()) return false;
-                    // Рекурсивная проверка вложенности
-                    if (!validateDocument(doc[key], typeVal)) return false;
-                } 
-                // Если в схеме это строка с названием типа
-                else if (typeVal.is_string()) {
-                    string type = typeVal.get<string>();
-                    
-                    if (type == "int") {
-                        if (!doc[key].is_number_integer()) return false;
-                    } 
-                    else if (type == "string" || type == "str") {
-                        if (!doc[key].is_string()) return false;
-                    } 
-                    else if (type == "timestamp") {
-                        // Проверяем, что это строка И она соответствует формату
-                        if (!doc[key].is_string()) return false;
-                        if (!isValidTimestamp(doc[key].get<string>())) return false;
-                    }
+    void appendChunkFiles(const string& dir, ArenaArray<string>& files) {
+        for (int idx : getFileIndexes(dir)) {
+            files.push_back(dir + "/" + to_string(idx) + ".json");
+        }
+    }
+
+    // Длина метки периода в ISO-строке: 2024, 2024-02, 2024-02-29, 2024-02-29T13
+    size_t periodLabelLength() const {
+        switch (granularity) {
+            case Granularity::Hour: return 13;
+            case Granularity::Day: return 10;
+            case Granularity::Month: return 7;
+            case Granularity::Year: return 4;
+        }
+        return 10;
+    }
+
+    // Начало периода, в который попадает момент времени
+    int64_t periodStart(int64_t epoch) const {
+        if (granularity == Granularity::Hour || granularity == Granularity::Day) {
+            const int64_t len = granularity == Granularity::Hour ? 3600 : 86400;
+            int64_t start = epoch / len * len;
+            return start > epoch ? start - len : start;  // Округление вниз для дат до 1970 года
+        }
+        Timestamp t = Timestamp::fromEpoch(epoch);
+        if (granularity == Granularity::Year) t.month = 1;
+        t.day = 1;
+        t.hour = t.minute = t.second = 0;
+        return t.toEpoch();
+    }
+
+    // Начало следующего периода
+    int64_t periodEnd(int64_t start) const {
+        if (granularity == Granularity::Hour) return start + 3600;
+        if (granularity == Granularity::Day) return start + 86400;
+        Timestamp t = Timestamp::fromEpoch(start);
+        if (granularity == Granularity::Year) {
+            t.year++;
+        } else if (++t.month > 12) {
+            t.month = 1;
+            t.year++;
+        }
+        return t.toEpoch();
+    }
+
+    string periodLabel(int64_t start) const {
+        return Timestamp::fromEpoch(start).toString().substr(0, periodLabelLength());
+    }
+
+    // Имя каталога секции -> начало периода
+    bool parsePeriodLabel(const string& label, int64_t& start) const {
+        static const string epochTemplate = "0000-01-01T00:00:00";
+        if (label.size() != periodLabelLength()) return false;
+        Timestamp t;
+        if (!Timestamp::parse(label + epochTemplate.substr(label.size()), t)) return false;
+        start = t.toEpoch();
+        return periodStart(start) == start;
+    }
+
+    // Каталог, в который попадает документ
+    string chunkDirFor(const json& doc) const {
+        if (partitionField.empty()) return path;
+        auto it = doc.find(partitionField);
+        if (it == doc.end() || !it->is_number_integer()) return path;
+        Timestamp t = Timestamp::fromEpoch(it->get<int64_t>());
+        if (t.year < 0 || t.year > 9999) return path;  // Метка периода не уместится в формат
+        return path + "/" + periodLabel(periodStart(it->get<int64_t>()));
+    }
+
+    // Начала всех существующих секций по возрастанию
+    ArenaArray<int64_t> listPartitions() {
+        ArenaArray<int64_t> starts;
+        if (partitionField.empty() || !filesystem::exists(path)) return starts;
+        for (const auto& entry : filesystem::directory_iterator(path)) {
+            int64_t start = 0;
+            if (entry.is_directory() && parsePeriodLabel(entry.path().filename().string(), start)) {
+                starts.push_back(start);
+            }
+        }
+        sort(starts.begin(), starts.end());
+        return starts;
+    }
+
+    static void tightenBounds(const json& arg, const string& op, int64_t& lo, int64_t& hi) {
+        if (op == "$in") {
+            if (!arg.is_array() || arg.empty()) return;
+            int64_t minVal = INT64_MAX, maxVal = INT64_MIN;
+            for (const auto& item : arg) {
+                if (!item.is_number_integer()) return;
+                minVal = min(minVal, item.get<int64_t>());
+                maxVal = max(maxVal, item.get<int64_t>());
+            }
+            lo = max(lo, minVal);
+            hi = min(hi, maxVal);
+            return;
+        }
+        if (!arg.is_number_integer()) return;
+        int64_t v = arg.get<int64_t>();
+        if (op == "$eq") { lo = max(lo, v); hi = min(hi, v); }
+        else if (op == "$gt") { if (v == INT64_MAX) hi = INT64_MIN; else lo = max(lo, v + 1); }
+        else if (op == "$gte") { lo = max(lo, v); }
+        else if (op == "$lt") { if (v == INT64_MIN) lo = INT64_MAX; else hi = min(hi, v - 1); }
+        else if (op == "$lte") { hi = min(hi, v); }
+    }
+
+    // Диапазон значений поля секционирования, которым ограничен запрос.
+    // Повторяет порядок разбора в matchDocument: $and и $or перекрывают остальные поля
+    void queryBounds(const json& query, int64_t& lo, int64_t& hi) const {
+        if (!query.is_object()) return;
+        if (query.contains("$and")) {
+            for (const auto& subQuery : query["$and"]) queryBounds(subQuery, lo, hi);
+            return;
+        }
+        if (query.contains("$or")) return;
+
+        auto it = query.find(partitionField);
+        if (it == query.end()) return;
+        if (!it->is_object()) {
+            tightenBounds(*it, "$eq", lo, hi);
+            return;
+        }
+        for (auto& [op, arg] : it->items()) tightenBounds(arg, op, lo, hi);
+    }
+
+    // Файлы чанков, которые может затронуть запрос.
+    // Несекционированные чанки просматриваются всегда, секции — только пересекающиеся с запросом
+    ArenaArray<string> chunkFiles(const json& query) {
+        ArenaArray<string> files;
+        appendChunkFiles(path, files);
+        if (partitionField.empty()) return files;
+
+        int64_t lo = INT64_MIN;
+        int64_t hi = INT64_MAX;
+        queryBounds(query, lo, hi);
+        for (int64_t start : listPartitions()) {
+            if (periodEnd(start) <= lo || start > hi) continue;
+            appendChunkFiles(path + "/" + periodLabel(start), files);
+        }
+        return files;
+    }
+
+    // Поля типа timestamp хранятся как int64 секунды от эпохи Unix:
+    // сравнения в checkCondition и $inc работают с целыми числами,
+    // а ISO-строка формируется только при выдаче результата
+    static bool isTimestampType(const json& typeVal) {
+        return typeVal.is_string() && typeVal.get_ref<const string&>() == "timestamp";
+    }
+
+    // ISO-строки в timestamp-полях документа -> int64
+    void encodeTimestamps(json& doc) const {
+        validator.forEachField(doc, FieldType::Timestamp, [](json& value) {
+            Timestamp ts;
+            if (value.is_string() && Timestamp::parse(value.get_ref<const string&>(), ts)) value = ts.toEpoch();
+        });
+    }
+
+    // int64 в timestamp-полях документа -> ISO-строки (только на выходе)
+    void decodeTimestamps(json& doc) const {
+        validator.forEachField(doc, FieldType::Timestamp, [](json& value) {
+            if (value.is_number_integer()) value = Timestamp::fromEpoch(value.get<int64_t>()).toString();
+        });
+    }
+
+    // Переводит ISO-строки в условиях на timestamp-поле в int64
+    static void encodeTimestampCondition(json& condition) {
+        if (condition.is_string()) {
+            Timestamp ts;
+            if (Timestamp::parse(condition.get_ref<const string&>(), ts)) condition = ts.toEpoch();
+        } else if (condition.is_array()) {
+            for (auto& item : condition) encodeTimestampCondition(item);  // $in
+        } else if (condition.is_object()) {
+            for (auto& [op, arg] : condition.items()) encodeTimestampCondition(arg);
+        }
+    }
+
+    // Приводит литералы запроса к внутреннему представлению полей
+    static void encodeQuery(json& query, const json& schemaSubset) {
+        if (!query.is_object()) return;
+        for (auto& [key, condition] : query.items()) {
+            if (key == "$and" || key == "$or") {
+                if (condition.is_array()) {
+                    for (auto& subQuery : condition) encodeQuery(subQuery, schemaSubset);
                 }
+                continue;
+            }
+            auto it = schemaSubset.find(key);
+            if (it == schemaSubset.end()) continue;
+            if (isTimestampType(*it)) {
+                encodeTimestampCondition(condition);
+            } else if (it->is_object() && condition.is_object()) {
+                encodeQuery(condition, *it);
+            }
+        }
+    }
+
+    // Чтение чанка с приведением старых строковых timestamp к int64
+    bool readChunk(const string& fpath, json& chunk) {
+        ifstream in(fpath);
+        if (in.good()) {
+            try { in >> chunk; } catch(...) {
+                cerr << "Couldn't read file data from " << fpath << " Skipping..." << endl;
+                return false;
             }
         }
+        in.close();
+        for (auto& [key, doc] : chunk.items()) encodeTimestamps(doc);
         return true;
     }
 
-public:
-    Collection(string newName, string newPath, size_t limit, json initialStructure) 
-                                                                                : name(newName),
-                                                                                path(newPath),
-                                                                                tuples_limit(limit),
-                                                                                structure(initialStructure)
-    {
-        if (!filesystem::exists(path)) {
-            filesystem::create_directories(path);
-            ofstream out(path + "/1.json");
-            out << "{}";
-            out.close();
+    uint32_t chunkRef(const string& fpath) {
+        auto it = chunkRefs.find(fpath);
+        if (it != chunkRefs.end()) return it->second;
+        // Номер чанка в IdEntry 32-битный ради компактности индекса
+        if (chunkPaths.GetSize() >= AmbiguousChunk) throw length_error("Too many chunk files in collection " + name);
+        uint32_t ref = static_cast<uint32_t>(chunkPaths.GetSize());
+        chunkPaths.push_back(fpath);
+        chunkRefs.insert(fpath, ref);
+        return ref;
+    }
+
+    IdEntry* idLowerBound(const ObjectId& id) {
+        return lower_bound(idIndex.begin(), idIndex.end(), id,
+                           [](const IdEntry& e, const ObjectId& key) { return e.id < key; });
+    }
+
+    // Добавление id в индекс. Id генерируются по возрастанию,
+    // поэтому обычно вставка идёт в конец массива без сдвига
+    void indexId(const string& key, const string& fpath) {
+        ObjectId id;
+        if (!ObjectId::parse(key, id)) {
+            hasUnindexedIds = true;
+            return;
         }
+        IdEntry entry;
+        entry.id = id;
+        entry.chunk = chunkRef(fpath);
+
+        IdEntry* pos = idLowerBound(id);
+        if (pos != idIndex.end() && pos->id == id) {
+            if (pos->chunk != entry.chunk) pos->chunk = AmbiguousChunk;
+            return;
+        }
+        idIndex.MPUSH_BY_IND(static_cast<decltype(idIndex)::size_type>(pos - idIndex.begin()), entry);
     }
 
-    string insert(json document) {
-        // Проверка схемы перед вставкой
-        if (!validateDocument(document, structure)) {
-            cerr << "Error: Document structure or types do not match the schema in collection '" << name << "'." << endl;
-            return "";
+    void unindexId(const string& key) {
+        ObjectId id;
+        if (!idIndexBuilt || !ObjectId::parse(key, id)) return;
+        IdEntry* pos = idLowerBound(id);
+        if (pos != idIndex.end() && pos->id == id && pos->chunk != AmbiguousChunk) {
+            idIndex.MDEL_BY_IND(static_cast<decltype(idIndex)::size_type>(pos - idIndex.begin()));
         }
+    }
+
+    // Удаление группы id одним проходом по индексу вместо сдвига на каждый id
+    template <typename Keys>
+    void unindexIds(const Keys& keys) {
+        if (!idIndexBuilt || keys.empty()) return;
+        if (keys.GetSize() == 1) {
+            unindexId(keys[0]);
+            return;
+        }
+        SmallArray<ObjectId, 8, ArenaAllocator> ids;
+        ids.reserve(keys.GetSize());
+        for (const auto& key : keys) {
+            ObjectId id;
+            if (ObjectId::parse(key, id)) ids.push_back(id);
+        }
+        sort(ids.begin(), ids.end());
+        idIndex.erase_if([&ids](const IdEntry& e) {
+            return e.chunk != AmbiguousChunk && binary_search(ids.begin(), ids.end(), e.id);
+        });
+    }
+
+    void invalidateIdIndex() {
+        idIndex.clear();
+        idIndexBuilt = false;
+        hasUnindexedIds = false;
+    }
+
+    // Индекс строится один раз при первом поиске по _id
+    void ensureIdIndex() {
+        if (idIndexBuilt) return;
+        invalidateIdIndex();
+        for (const auto& fpath : chunkFiles(json::object())) {
+            json chunk;
+            if (!readChunk(fpath, chunk)) continue;
+            for (auto& [key, doc] : chunk.items()) indexId(key, fpath);
+        }
+        idIndexBuilt = true;
+    }
+
+    // Чанки для запроса вида {"_id": id}, {"_id": {"$eq": id}} или {"_id": {"$in": [...]}}.
+    // Возвращает false, если запрос не по _id или id нельзя найти через индекс
+    bool idLookupFiles(const json& query, ArenaArray<string>& files) {
+        if (!query.is_object() || query.size() != 1 || !query.contains("_id")) return false;
+        const json& cond = query["_id"];
+        const json* ids = &cond;
+        if (cond.is_object()) {
+            if (cond.size() != 1) return false;
+            if (cond.contains("$eq")) ids = &cond["$eq"];
+            else if (cond.contains("$in") && cond["$in"].is_array()) ids = &cond["$in"];
+            else return false;
+        }
+
+        ensureIdIndex();
+        SmallArray<uint32_t, 8, ArenaAllocator> refs;  // Обычно один-два чанка
+        auto addId = [&](const json& value) -> bool {
+            if (!value.is_string()) return false;
+            ObjectId id;
+            if (!ObjectId::parse(value.get_ref<const string&>(), id)) {
+                return !hasUnindexedIds;  // Такого id нет ни у одного документа
+            }
+            IdEntry* pos = idLowerBound(id);
+            if (pos != idIndex.end() && pos->id == id && pos->chunk == AmbiguousChunk) {
+                return false;  // Документов с этим id несколько: нужен просмотр
+            }
+            if (pos != idIndex.end() && pos->id == id
+                && std::find(refs.begin(), refs.end(), pos->chunk) == refs.end()) {
+                refs.push_back(pos->chunk);
+            }
+            return true;
+        };
+
+        if (ids->is_array()) {
+            for (const auto& value : *ids) {
+                if (!addId(value)) return false;
+            }
+        } else if (!addId(*ids)) {
+            return false;
+        }
+
+        for (uint32_t ref : refs) files.push_back(chunkPaths[ref]);
+        return true;
+    }
+
+    // Чанки, которые нужно просмотреть для запроса: через индекс _id или по секциям
+    ArenaArray<string> candidateFiles(const json& query) {
+        ArenaArray<string> files;
+        if (idLookupFiles(query, files)) return files;
+        return chunkFiles(query);
+    }
+
+    // Вставка уже проверенного по схеме документа
+    string insertValidated(json document) {
+        encodeTimestamps(document);
 
         string id;
         if (document.contains("_id")) id = document["_id"];
         else id = generateId(); 
         document["_id"] = id; 
 
-        auto indexes = getFileIndexes();
+        string dir = chunkDirFor(document);
+        if (!filesystem::exists(dir)) filesystem::create_directories(dir);
+
+        auto indexes = getFileIndexes(dir);
         int lastIdx = indexes.back();
-        string filePath = path + "/" + to_string(lastIdx) + ".json";
+        string filePath = dir + "/" + to_string(lastIdx) + ".json";
         
         json fileData;
         if (filesystem::exists(filePath) && filesystem::file_size(filePath) > 0) {
@@ -284,7 +869,7 @@ public:
         }
 
         if (fileData.size() >= tuples_limit) {
-            filePath = path + "/" + to_string(++lastIdx) + ".json";
+            filePath = dir + "/" + to_string(++lastIdx) + ".json";
             fileData = json::object();
         }
 
@@ -293,9 +878,62 @@ public:
         ofstream out(filePath);
         out << fileData.dump(4);
         out.close();
+        if (idIndexBuilt) indexId(id, filePath);
         return id;
     }
 
+    void reportSchemaMismatch() const {
+        cerr << "Error: Document structure or types do not match the schema in collection '" << name << "'." << endl;
+    }
+
+public:
+    Collection(string newName, string newPath, size_t limit, json initialStructure, const json& partitionSpec = nullptr) 
+                                                                                : name(newName),
+                                                                                path(newPath),
+                                                                                tuples_limit(limit),
+                                                                                structure(initialStructure),
+                                                                                validator(structure)
+    {
+        // Индекс _id живёт всё время работы и растёт с коллекцией: рост 1.5x экономит память
+        idIndex.setGrowth(Growth::OneAndHalf);
+        chunkRefs.setStatsEnabled(true);  // Для команды stats; таблица небольшая
+
+        if (!filesystem::exists(path)) {
+            filesystem::create_directories(path);
+            ofstream out(path + "/1.json");
+            out << "{}";
+            out.close();
+        }
+
+        // Настройка секционирования: {"partition_by": "hunted", "granularity": "day"}
+        if (partitionSpec.is_object() && partitionSpec.contains("partition_by")) {
+            string field = partitionSpec["partition_by"].get<string>();
+            string unit = partitionSpec.value("granularity", "day");
+            if (!structure.contains(field) || !isTimestampType(structure[field])) {
+                cerr << "Warning: partition field '" << field << "' of collection '" << name
+                     << "' is not a timestamp, partitioning disabled" << endl;
+            } else if (unit != "hour" && unit != "day" && unit != "month" && unit != "year") {
+                cerr << "Warning: unknown partition granularity '" << unit << "' in collection '" << name
+                     << "', partitioning disabled" << endl;
+            } else {
+                partitionField = field;
+                if (unit == "hour") granularity = Granularity::Hour;
+                else if (unit == "day") granularity = Granularity::Day;
+                else if (unit == "month") granularity = Granularity::Month;
+                else granularity = Granularity::Year;
+            }
+        }
+    }
+
+    string insert(json document) {
+        // Проверка схемы перед вставкой
+        if (!validator.validate(document)) {
+            reportSchemaMismatch();
+            return "";
+        }
+        return insertValidated(std::move(document));
+    }
+
     void insert_one(const json& document) {
         if (document.is_array()) {
             cerr << "Expected one document" << endl;
@@ -309,25 +947,26 @@ public:
             cerr << "insert_many expects an array of documents" << endl;
             return;
         }
+        // Пакетная проверка: сначала валидируем все документы, затем вставляем корректные
+        Array<bool> valid;
+        validator.validateBatch(documents, valid);
+
+        uint32_t i = 0;
         for (const auto& doc : documents) {
-            insert(doc);
+            if (valid[i++]) insertValidated(doc);
+            else reportSchemaMismatch();
         }
     }
 
-    json find(const json& query, const json& projection = nullptr, bool findOne = false) {
+    json find(const json& rawQuery, const json& projection = nullptr, bool findOne = false) {
         json result = json::array();
-        auto indexes = getFileIndexes();
+        json query = rawQuery;
+        encodeQuery(query, structure);
+        auto files = candidateFiles(query);
 
-        for (int idx : indexes) {
-            ifstream in(path + "/" + to_string(idx) + ".json");
+        for (const auto& fpath : files) {
             json chunk;
-            if (in.good()) {
-                try { in >> chunk; } catch(...) {
-                    cerr << "Couldn't read file data from " << path + "/" + to_string(idx) + ".json Skipping..." << endl;
-                    continue;
-                }
-            }
-            in.close();
+            if (!readChunk(fpath, chunk)) continue;
 
             for (auto& [key, doc] : chunk.items()) {
                 if (matchDocument(doc, query)) {
@@ -345,8 +984,10 @@ public:
                                 if (doc.contains(pKey)) projectedDoc[pKey] = doc[pKey];
                             }
                         }
+                        decodeTimestamps(projectedDoc);
                         result.push_back(projectedDoc);
                     } else {
+                        decodeTimestamps(doc);
                         result.push_back(doc);
                     }
                     if (findOne) return result;
@@ -369,30 +1010,43 @@ public:
         return result[0];
     }
 
-    void update(const json& query, const json& updateOps, bool multi = false) {
-        auto indexes = getFileIndexes();
+    void update(const json& rawQuery, const json& updateOps, bool multi = false) {
+        json query = rawQuery;
+        encodeQuery(query, structure);
+        auto files = candidateFiles(query);
         bool updatedOne = false;
+        // Документы, у которых после обновления сменилась секция.
+        // Вставляются после обхода, чтобы update_many не обработал их повторно
+        ArenaArray<json> moved;
+
+        // Значения $set приводятся к внутреннему виду один раз. Timestamp-поле принимает
+        // только корректную ISO-строку: иначе в документе осталась бы строка вместо int64,
+        // и следующий $inc или вывод документа завершились бы ошибкой
+        json setOps;
+        if (updateOps.contains("$set")) {
+            setOps = updateOps["$set"];
+            encodeTimestamps(setOps);
+            validator.forEachField(setOps, FieldType::Timestamp, [](json& value) {
+                if (!value.is_number_integer()) {
+                    throw invalid_argument("Invalid timestamp value in $set: " + value.dump());
+                }
+            });
+        }
 
-        for (int idx : indexes) {
+        for (const auto& fpath : files) {
             if (!multi && updatedOne) break; 
 
-            string fpath = path + "/" + to_string(idx) + ".json";
-            ifstream in(fpath);
             json chunk; 
-                if (in.good()) {
-                    try { in >> chunk; } catch(...) {
-                    cerr << "Couldn't read file data from " << path + "/" + to_string(idx) + ".json Skipping..." << endl;
-                    continue;
-                }
-            }
-            in.close();
+            if (!readChunk(fpath, chunk)) continue;
 
+            string chunkDir = filesystem::path(fpath).parent_path().string();
+            SmallArray<string, 4, ArenaAllocator> keysToMove;
             bool fileChanged = false;
             for (auto& [key, doc] : chunk.items()) {
                 if (matchDocument(doc, query)) {
                     // Обработка $set
                     if (updateOps.contains("$set")) {
-                        for (auto& [k, v] : updateOps["$set"].items()) doc[k] = v;
+                        for (auto& [k, v] : setOps.items()) doc[k] = v;
                     }
                     // Обработка $inc
                     if (updateOps.contains("$inc")) {
@@ -406,14 +1060,14 @@ public:
 
                                 // Логика для Timestamp
                                 if (fieldType == "timestamp") {
-                                    // Создаем структуру из текущей строки
-                                    Timestamp ts(doc[k].get<string>());
-                                    
-                                    // Прибавляем секунды
-                                    ts.addSeconds(v.get<int>());
-                                    
-                                    // Записываем обратно строку
-                                    doc[k] = ts.toString();
+                                    // Поле хранится как int64. addSeconds проверяет переполнение и то,
+                                    // что результат ещё выводится строкой, до изменения документа
+                                    if (!doc[k].is_number_integer() || !v.is_number_integer()) {
+                                        throw invalid_argument("$inc on timestamp field '" + k + "' needs integer seconds");
+                                    }
+                                    Timestamp ts = Timestamp::fromEpoch(doc[k].get<int64_t>());
+                                    ts.addSeconds(v.get<int64_t>());
+                                    doc[k] = ts.toEpoch();
                                 } 
                                 // Логика для обычных чисел
                                 else {
@@ -430,18 +1084,27 @@ public:
                          }
                     }
                     
+                    if (!partitionField.empty() && chunkDirFor(doc) != chunkDir) {
+                        moved.push_back(doc);
+                        keysToMove.push_back(key);
+                    }
+
                     fileChanged = true;
                     updatedOne = true;
                     if (!multi) break; 
                 }
             }
 
+            for (const auto& k : keysToMove) chunk.erase(k);
+            unindexIds(keysToMove);
             if (fileChanged) {
                 ofstream out(fpath);
                 out << chunk.dump(4);
                 out.close();
             }
         }
+
+        for (const auto& doc : moved) insertValidated(doc);
     }
 
     void update_one(const json& query, const json& updateOps) {
@@ -452,25 +1115,19 @@ public:
         update(query, updateOps, true);
     }
 
-    void remove(const json& query, bool multi = false) {
-        auto indexes = getFileIndexes();
+    void remove(const json& rawQuery, bool multi = false) {
+        json query = rawQuery;
+        encodeQuery(query, structure);
+        auto files = candidateFiles(query);
         bool deletedOne = false;
 
-        for (int idx : indexes) {
+        for (const auto& fpath : files) {
             if (!multi && deletedOne) break;
 
-            string fpath = path + "/" + to_string(idx) + ".json";
-            ifstream in(fpath);
             json chunk;
-                if (in.good()) {
-                    try { in >> chunk; } catch(...) {
-                    cerr << "Couldn't read file data from " << path + "/" + to_string(idx) + ".json Skipping..." << endl;
-                    continue;
-                }
-            }
-            in.close();
+            if (!readChunk(fpath, chunk)) continue;
 
-            Array<string> keysToDelete;
+            SmallArray<string, 4, ArenaAllocator> keysToDelete;
             for (auto& [key, doc] : chunk.items()) {
                 if (matchDocument(doc, query)) {
                     keysToDelete.push_back(key);
@@ -480,7 +1137,8 @@ public:
             }
 
             if (!keysToDelete.empty()) {
-                for(const auto& k : keysToDelete) chunk.erase(k);
+                for (const auto& k : keysToDelete) chunk.erase(k);
+                unindexIds(keysToDelete);
                 ofstream out(fpath);
                 out << chunk.dump(4); 
                 out.close();
@@ -495,16 +1153,50 @@ public:
     void delete_many(const json& query) {
         remove(query, true);
     }
+
+    // Удаление секций, период которых целиком раньше cutoff: по одному каталогу на секцию,
+    // без чтения документов. Возвращает количество удалённых секций
+    uint32_t drop_partitions_before(int64_t cutoff) {
+        uint32_t dropped = 0;
+        for (int64_t start : listPartitions()) {
+            if (periodEnd(start) > cutoff) break;
+            filesystem::remove_all(path + "/" + periodLabel(start));
+            dropped++;
+        }
+        if (dropped > 0) invalidateIdIndex();  // Индекс перестроится при следующем поиске
+        return dropped;
+    }
+
+    void drop_partitions(const json& args) {
+        if (partitionField.empty()) {
+            cerr << "Collection '" << name << "' is not partitioned." << endl;
+            return;
+        }
+        Timestamp cutoff;
+        if (!args.is_object() || !args.contains("before") || !args["before"].is_string()
+            || !Timestamp::parse(args["before"].get_ref<const string&>(), cutoff)) {
+            cerr << "drop_partitions expects {\"before\": \"YYYY-MM-DDTHH:MM:SS\"}" << endl;
+            return;
+        }
+        cout << "Dropped partitions: " << drop_partitions_before(cutoff.toEpoch()) << endl;
+    }
+
+    // Статистика хэш-таблицы путей чанков
+    void printStats(ostream& out) const {
+        out << "Collection '" << name << "' chunk index:" << endl;
+        chunkRefs.stats().print(out);
+    }
 };
 
 class DBMS {
     string schemaName;
     string configPath;
     size_t tuplesLimit;
-    DoubleHash<Collection*> collections;
+    ConcurrentHash<Collection*> collections;   // Читается без блокировок
 
 public:
     DBMS(const string& cfgPath) : configPath(cfgPath) {
+        collections.setStatsEnabled(true);  // Для команды stats
         ifstream f(configPath);
         if (!f.is_open()) {
             cout << "Config file not found. Creating default schema with NESTED structures..." << endl;
@@ -552,28 +1244,34 @@ public:
             filesystem::create_directory(schemaName);
         }
 
+        // Необязательное секционирование: "partitions": {"users": {"partition_by": "hunted", "granularity": "day"}}
+        json partitions = config.value("partitions", json::object());
+
         for (auto& [colName, schemaStruct] : config["structure"].items()) {
             string colPath = schemaName + "/" + colName;
-            collections[colName] = new Collection(colName, colPath, tuplesLimit, schemaStruct);
+            json partitionSpec = partitions.contains(colName) ? partitions[colName] : json(nullptr);
+            collections.insert(colName, new Collection(colName, colPath, tuplesLimit, schemaStruct, partitionSpec));
         }
     }
     
-    Collection* getCollection(const string& name) {
-        if (collections.find(name) != collections.end()) {
-            return collections[name];
-        }
-        return nullptr;
+    // Поиск по string_view: имя берётся прямо из строки команды без копирования.
+    // Реестр можно читать из нескольких потоков одновременно
+    Collection* getCollection(string_view name) const {
+        return collections.find(name).value_or(nullptr);
     }
 
-    string getName() const { return schemaName; }
+    const string& getName() const { return schemaName; }
+
+    HashStats registryStats() const { return collections.stats(); }
     
     ~DBMS() {
-        for (auto& kv : collections) delete kv.second;
+        collections.forEach([](const string&, Collection* col) { delete col; });
     }
 };
 
 class ConsoleParser {
     DBMS& dbms;
+    Arena requestArena;   // Временные массивы команды; освобождаются целиком после неё
 
     // Структура для хранения разобранных аргументов
     struct ParsedArgs {
@@ -584,78 +1282,117 @@ class ConsoleParser {
         bool parseError = false;
     };
 
-    // Безопасное разделение строки аргументов
-    Array<string> splitArguments(string argsStr) {
-        Array<string> args;
-        string buffer;
-        int balanceBrace = 0;   // {}
-        int balanceBracket = 0; // []
-        
-        for (size_t i = 0; i < argsStr.length(); ++i) {
-            char c = argsStr[i];
-            
-            if (c == '{') balanceBrace++;
-            else if (c == '}') balanceBrace--;
-            else if (c == '[') balanceBracket++;
-            else if (c == ']') balanceBracket--;
-            
-            // Разделяем по запятой, только если мы не внутри объекта/массива
-            if (c == ',' && balanceBrace == 0 && balanceBracket == 0) {
-                // Триминг пробелов
-                size_t first = buffer.find_first_not_of(" \t");
-                size_t last = buffer.find_last_not_of(" \t");
-                if (first != string::npos) {
-                    args.push_back(buffer.substr(first, (last - first + 1)));
-                }
-                buffer = "";
-            } else {
-                buffer += c;
+    // Разобранная команда: все поля указывают в исходную строку без копирования
+    struct CommandTokens {
+        string_view dbName;
+        string_view colName;
+        string_view method;
+        string_view args;
+    };
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+    }
+
+    // Аналог \w из регулярных выражений
+    static bool isIdentChar(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+    }
+
+    static string_view trim(string_view s) {
+        size_t first = 0;
+        size_t last = s.size();
+        while (first < last && isSpace(s[first])) first++;
+        while (last > first && isSpace(s[last - 1])) last--;
+        return s.substr(first, last - first);
+    }
+
+    // Считывает идентификатор и следующий за ним разделитель
+    static bool lexIdentifier(string_view s, size_t& pos, char delimiter, string_view& out) {
+        size_t start = pos;
+        while (pos < s.size() && isIdentChar(s[pos])) pos++;
+        if (pos == start || pos >= s.size() || s[pos] != delimiter) return false;
+        out = s.substr(start, pos - start);
+        pos++;  // Пропускаем разделитель
+        return true;
+    }
+
+    // Разбор структуры db.collection.method(args) за один проход без regex
+    static bool lexCommand(string_view line, CommandTokens& tokens) {
+        line = trim(line);
+        size_t pos = 0;
+        if (!lexIdentifier(line, pos, '.', tokens.dbName)) return false;
+        if (!lexIdentifier(line, pos, '.', tokens.colName)) return false;
+        if (!lexIdentifier(line, pos, '(', tokens.method)) return false;
+        if (line.empty() || line.back() != ')' || pos > line.size() - 1) return false;
+        tokens.args = line.substr(pos, line.size() - 1 - pos);
+        return true;
+    }
+
+    // Поиск конца аргумента: запятая на нулевой глубине вложенности.
+    // Скобки внутри JSON-строк не учитываются
+    static size_t scanArgumentEnd(string_view s, size_t pos) {
+        int depth = 0;  // {} и []
+        bool inString = false;
+        for (; pos < s.size(); ++pos) {
+            char c = s[pos];
+            if (inString) {
+                if (c == '\\') pos++;  // Пропускаем экранированный символ
+                else if (c == '"') inString = false;
+                continue;
             }
+            if (c == '"') inString = true;
+            else if (c == '{' || c == '[') depth++;
+            else if (c == '}' || c == ']') depth--;
+            else if (c == ',' && depth == 0) return pos;
         }
-        // Добавляем последний аргумент
-        size_t first = buffer.find_first_not_of(" \t");
-        size_t last = buffer.find_last_not_of(" \t");
-        if (first != string::npos) {
-            args.push_back(buffer.substr(first, (last - first + 1)));
-        }
-        
-        return args;
+        return pos;
+    }
+
+    static bool startsWith(string_view s, string_view prefix) {
+        return s.substr(0, prefix.size()) == prefix;
     }
 
-    // Парсинг значений (True/False) и именованных параметров
-    ParsedArgs parseArgsInternal(const Array<string>& rawArgs) {
+    // Разбор аргументов и именованных параметров (multi=, projection=) за один проход.
+    // JSON парсится прямо из исходной строки, без промежуточных копий
+    ParsedArgs parseArguments(string_view argsStr) {
         ParsedArgs res;
-        
-        for (uint32_t i = 0; i < rawArgs.GetSize(); ++i) {
-            string current = rawArgs[i];
-            
+        size_t pos = 0;
+        uint32_t argNumber = 0;     // Номер аргумента для сообщений об ошибках
+        uint32_t positional = 0;    // Номер позиционного аргумента
+
+        while (pos < argsStr.size()) {
+            size_t end = scanArgumentEnd(argsStr, pos);
+            string_view current = trim(argsStr.substr(pos, end - pos));
+            pos = end + 1;  // Пропускаем запятую
+            if (current.empty()) continue;
+            argNumber++;
+
             // Обработка projection=
-            if (current.rfind("projection=", 0) == 0) {
-                string val = current.substr(11);
+            if (startsWith(current, "projection=")) {
+                string_view val = current.substr(11);
                 try {
-                    res.arg2 = json::parse(val);
+                    res.arg2 = json::parse(val.data(), val.data() + val.size());
                     res.hasArg2 = true;
                 } catch (...) { cerr << "Invalid projection JSON" << endl; }
                 continue;
             }
-            
+
             // Обработка multi=True/False
-            if (current.find("multi=") != string::npos) {
-                if (current.find("True") != string::npos || current.find("true") != string::npos) {
-                    res.multi = true;
-                } else {
-                    res.multi = false;
-                }
+            if (startsWith(current, "multi=")) {
+                string_view val = trim(current.substr(6));
+                res.multi = (val == "True" || val == "true");
                 continue;
             }
 
             // Обычные JSON аргументы
             try {
-                json j = json::parse(current);
-                if (i == 0) res.arg1 = j;
-                else if (i == 1) { res.arg2 = j; res.hasArg2 = true; }
+                json j = json::parse(current.data(), current.data() + current.size());
+                if (positional == 0) res.arg1 = std::move(j);
+                else if (positional == 1) { res.arg2 = std::move(j); res.hasArg2 = true; }
+                positional++;
             } catch (json::parse_error& e) {
-                cerr << "JSON Parse Error at argument " << i+1 << ": " << e.what() << endl;
+                cerr << "JSON Parse Error at argument " << argNumber << ": " << e.what() << endl;
                 res.parseError = true;
             }
         }
@@ -669,36 +1406,32 @@ public:
         // Защита от пустых строк
         if (commandLine.empty()) return;
 
+        ArenaScope scope(requestArena);
+
         // Базовая валидация структуры: dbName.collName.method(args)
-        regex cmdPattern(R"(^(\w+)\.(\w+)\.(\w+)\((.*)\)$)");
-        smatch matches;
-        
-        if (!regex_match(commandLine, matches, cmdPattern)) {
+        CommandTokens tokens;
+        if (!lexCommand(commandLine, tokens)) {
             cerr << "Syntax Error. Expected: db.collection.method(args)" << endl;
             return;
         }
 
-        string dbName = matches[1];
-        string colName = matches[2];
-        string method = matches[3];
-        string argsStr = matches[4];
+        string_view method = tokens.method;
 
         // Проверка имени БД
-        if (dbName != dbms.getName()) {
-            cerr << "Error: Unknown database '" << dbName << "'" << endl;
+        if (tokens.dbName != dbms.getName()) {
+            cerr << "Error: Unknown database '" << tokens.dbName << "'" << endl;
             return;
         }
 
         // Получение коллекции
-        Collection* col = dbms.getCollection(colName);
+        Collection* col = dbms.getCollection(tokens.colName);
         if (!col) {
-            cerr << "Error: Collection '" << colName << "' not found." << endl;
+            cerr << "Error: Collection '" << tokens.colName << "' not found." << endl;
             return;
         }
 
         // Парсинг аргументов
-        Array<string> rawArgs = splitArguments(argsStr);
-        ParsedArgs parsed = parseArgsInternal(rawArgs);
+        ParsedArgs parsed = parseArguments(tokens.args);
 
         if (parsed.parseError) return;
 
@@ -740,6 +1473,14 @@ public:
             else if (method == "delete_many") {
                 col->remove(parsed.arg1, true);
             }
+            else if (method == "drop_partitions") {
+                col->drop_partitions(parsed.arg1);
+            }
+            else if (method == "stats") {
+                col->printStats(cout);
+                cout << "Collection registry:" << endl;
+                dbms.registryStats().print(cout);
+            }
             else {
                 cerr << "Unknown method: " << method << endl;
             }
@@ -3,109 +3,595 @@
 
 #include <iostream>
 #include <cstdint>
-#include <cmath>
+#include <cstring>
 #include <string>
+#include <string_view>
 #include <fstream> 
 #include <stdexcept> 
+#include <utility>
+#include <new>
+#include <functional>
+#include <type_traits>
+#include <chrono>
 #include "array.hpp"
 
 using namespace std;
 
-// Структура для хранения пары ключ-значение
-template <typename T>
-struct HashNode {
-    string first;
+// 64x64 -> 128 умножение, свёрнутое в 64 бита (основа wyhash)
+inline uint64_t hashMix(uint64_t a, uint64_t b) {
+#if defined(__SIZEOF_INT128__)
+    __uint128_t r = static_cast<__uint128_t>(a) * b;
+    return static_cast<uint64_t>(r) ^ static_cast<uint64_t>(r >> 64);
+#else
+    // Переносимый вариант через 32-битные половины
+    uint64_t ha = a >> 32, la = a & 0xffffffffu, hb = b >> 32, lb = b & 0xffffffffu;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32);
+    uint64_t carry = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    carry += lo < t;
+    uint64_t hi = rh + (rm0 >> 32) + (rm1 >> 32) + carry;
+    return lo ^ hi;
+#endif
+}
+
+inline uint64_t hashRead8(const uint8_t* p) { uint64_t v; memcpy(&v, p, 8); return v; }
+inline uint64_t hashRead4(const uint8_t* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+
+// Хэш последовательности байтов в духе wyhash: по 8 байт за шаг, без деления и плавающей точки
+inline uint64_t hashBytes(const void* data, size_t len, uint64_t seed = 0) {
+    static constexpr uint64_t s0 = 0xa0761d6478bd642full;
+    static constexpr uint64_t s1 = 0xe7037ed1a0b428dbull;
+    static constexpr uint64_t s2 = 0x8ebc6af09c88c6e3ull;
+    static constexpr uint64_t s3 = 0x589965cc75374cc3ull;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    seed ^= hashMix(seed ^ s0, s1);
+    uint64_t a = 0, b = 0;
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (hashRead4(p) << 32) | hashRead4(p + ((len >> 3) << 2));
+            b = (hashRead4(p + len - 4) << 32) | hashRead4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = (static_cast<uint64_t>(p[0]) << 16) | (static_cast<uint64_t>(p[len >> 1]) << 8) | p[len - 1];
+        }
+    } else {
+        size_t i = len;
+        if (i > 48) {
+            uint64_t see1 = seed, see2 = seed;
+            do {
+                seed = hashMix(hashRead8(p) ^ s1, hashRead8(p + 8) ^ seed);
+                see1 = hashMix(hashRead8(p + 16) ^ s2, hashRead8(p + 24) ^ see1);
+                see2 = hashMix(hashRead8(p + 32) ^ s3, hashRead8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = hashMix(hashRead8(p) ^ s1, hashRead8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = hashRead8(p + i - 16);
+        b = hashRead8(p + i - 8);
+    }
+    return hashMix(s1 ^ len, hashMix(a ^ s1, b ^ seed));
+}
+
+// Хэшер по умолчанию для строковых ключей.
+// Любой другой хэшер должен возвращать uint64_t с хорошо перемешанными битами
+// и принимать string_view, чтобы поиск без создания std::string давал тот же хэш
+struct WyHash {
+    uint64_t operator()(string_view key) const {
+        return hashBytes(key.data(), key.size());
+    }
+};
+
+// Хэшер по умолчанию для ключа типа K:
+// целые числа перемешиваются одним умножением, прочие тривиально копируемые
+// типы (бинарные id, составные ключи) хэшируются по байтам представления
+template <typename K, typename = void>
+struct DefaultHash {
+    static_assert(is_trivially_copyable_v<K> && has_unique_object_representations_v<K>,
+                  "DoubleHash key must be std::string or a trivially copyable type without padding");
+
+    uint64_t operator()(const K& key) const {
+        return hashBytes(&key, sizeof(K));
+    }
+};
+
+template <typename K>
+struct DefaultHash<K, enable_if_t<is_integral_v<K> || is_enum_v<K>>> {
+    uint64_t operator()(K key) const {
+        return hashMix(static_cast<uint64_t>(key) ^ 0xa0761d6478bd642full, 0xe7037ed1a0b428dbull);
+    }
+};
+
+template <>
+struct DefaultHash<string> : WyHash {};
+
+// Тип ключа для поиска: строки ищутся по string_view без выделения памяти
+template <typename K>
+struct HashLookup {
+    using type = const K&;
+};
+
+template <>
+struct HashLookup<string> {
+    using type = string_view;
+};
+
+// Структура для хранения пары ключ-значение. Ключ хранится прямо в узле
+// вместе с полным хэшем: он отсекает несовпадающие ключи без сравнения
+// и не пересчитывается при перестройке таблицы
+template <typename K, typename T>
+struct BasicHashNode {
+    K first;
     T second;
+    uint64_t hash;
     bool isOccupied;
+    bool isDeleted;   // Надгробие: ячейка освобождена, но цепочка пробирования через неё продолжается
 
-    HashNode() : first(""), second(T()), isOccupied(false) {}
+    BasicHashNode() : first(K()), second(T()), hash(0), isOccupied(false), isDeleted(false) {}
 
-    HashNode(const string& newKey, const T& newValue)
-        : first(newKey), second(newValue), isOccupied(true) {
+    BasicHashNode(const K& newKey, const T& newValue, uint64_t h = 0)
+        : first(newKey), second(newValue), hash(h), isOccupied(true), isDeleted(false) {
+    }
+
+    BasicHashNode(K&& newKey, T&& newValue, uint64_t h = 0)
+        : first(std::move(newKey)), second(std::move(newValue)), hash(h), isOccupied(true), isDeleted(false) {
+    }
+
+    // Занятый узел со значением, сконструированным из args на месте
+    template <typename KeyArg, typename... Args>
+    BasicHashNode(piecewise_construct_t, uint64_t h, KeyArg&& newKey, Args&&... args)
+        : first(std::forward<KeyArg>(newKey)), second(std::forward<Args>(args)...), hash(h), isOccupied(true),
+          isDeleted(false) {
     }
 };
 
 template <typename T>
-class DoubleHash {
+using HashNode = BasicHashNode<string, T>;
+
+// Статистика хэш-таблицы: гистограммы длины пробирования по операциям,
+// максимальная длина, число и время перестроек, а также снимок заполнения.
+// Корзина i — длина i + 1, последняя корзина — Buckets и больше
+struct HashStats {
+    static constexpr uint32_t Buckets = 16;
+
+    uint64_t findProbes[Buckets] = {};
+    uint64_t insertProbes[Buckets] = {};
+    uint64_t removeProbes[Buckets] = {};
+    uint32_t maxProbe = 0;
+    uint64_t resizes = 0;
+    uint64_t resizeNanos = 0;
+
+    // Заполняются при запросе статистики
+    uint64_t elements = 0;
+    uint64_t capacity = 0;
+    uint64_t tombstones = 0;
+
+    static uint32_t bucketFor(uint32_t probes) {
+        return probes == 0 ? 0 : (probes < Buckets ? probes - 1 : Buckets - 1);
+    }
+
+    static void record(uint64_t (&histogram)[Buckets], uint32_t probes, uint32_t& maxProbe) {
+        histogram[bucketFor(probes)]++;
+        if (probes > maxProbe) maxProbe = probes;
+    }
+
+    [[nodiscard]] auto loadFactor() const -> double {
+        return capacity == 0 ? 0.0 : static_cast<double>(elements) / static_cast<double>(capacity);
+    }
+
+    // Суммирование статистики нескольких таблиц (сегментов, коллекций)
+    void merge(const HashStats& other) {
+        for (uint32_t i = 0; i < Buckets; i++) {
+            findProbes[i] += other.findProbes[i];
+            insertProbes[i] += other.insertProbes[i];
+            removeProbes[i] += other.removeProbes[i];
+        }
+        if (other.maxProbe > maxProbe) maxProbe = other.maxProbe;
+        resizes += other.resizes;
+        resizeNanos += other.resizeNanos;
+        elements += other.elements;
+        capacity += other.capacity;
+        tombstones += other.tombstones;
+    }
+
+    void print(ostream& out) const {
+        out << "elements: " << elements << ", capacity: " << capacity
+            << ", tombstones: " << tombstones << ", load: " << loadFactor() << endl;
+        out << "max probe: " << maxProbe << ", resizes: " << resizes
+            << ", resize time: " << resizeNanos / 1000 << " us" << endl;
+        printHistogram(out, "find", findProbes);
+        printHistogram(out, "insert", insertProbes);
+        printHistogram(out, "remove", removeProbes);
+    }
+
  private:
-    Array<HashNode<T>> table;
-    uint32_t tableSize;        // Размер таблицы
-    uint32_t elementsCount;    // Количество элементов
-    // Дробная часть золотого сечения
-    const double A = (sqrt(5.0) - 1.0) / 2.0;
+    static void printHistogram(ostream& out, const char* name, const uint64_t (&histogram)[Buckets]) {
+        uint64_t total = 0;
+        uint64_t weighted = 0;
+        for (uint32_t i = 0; i < Buckets; i++) {
+            total += histogram[i];
+            weighted += histogram[i] * (i + 1);
+        }
+        out << name << " probes (" << total << " ops";
+        if (total != 0) out << ", avg " << static_cast<double>(weighted) / static_cast<double>(total);
+        out << "):";
+        for (uint32_t i = 0; i < Buckets; i++) {
+            if (histogram[i] == 0) continue;
+            out << " " << (i + 1) << (i + 1 == Buckets ? "+" : "") << "=" << histogram[i];
+        }
+        out << endl;
+    }
+};
 
-    // Первая хэш-функция: метод умножения
-    [[nodiscard]] auto hash1(const string& key) const -> uint32_t {
-        // Преобразуем строку в число
-        uint64_t numKey = 0;
-        for (char c : key) {
-            numKey = numKey * 31 + static_cast<uint64_t>(c);
+// Хэш-таблица с открытой адресацией и двойным хэшированием.
+// Размер таблицы — степень двойки, индекс получается маской вместо %.
+// Удаление оставляет надгробия, которые учитываются в пороге перестройки.
+// В инкрементальном режиме расширение не перехэширует всё сразу: старая таблица
+// остаётся рядом и переносится порциями по migrateBatch ячеек за операцию записи,
+// а новая таблица строится заранее, пока заполнение приближается к порогу.
+// Ключ — std::string или тривиально копируемый тип (целое, бинарный id);
+// Hash и Eq задают хэширование и сравнение ключей, Alloc — выделение памяти под ячейки.
+// Пустые ячейки хранят K() и V(), поэтому оба типа должны конструироваться по умолчанию
+template <typename K, typename V, typename Hash = DefaultHash<K>, typename Eq = equal_to<>,
+          typename Alloc = HeapAllocator>
+class BasicDoubleHash {
+ private:
+    using Node = BasicHashNode<K, V>;
+    using LookupKey = typename HashLookup<K>::type;
+
+    Array<Node, Alloc> table;
+    uint32_t tableSize;        // Размер таблицы (степень двойки)
+    uint32_t elementsCount;    // Количество элементов (в обеих таблицах во время миграции)
+    uint32_t tombstones;       // Количество надгробий в table
+    Hash hasher;
+    Eq keyEq;
+    HashStats counters;        // Пробирования и перестройки; заполнение считается в stats()
+    bool collectStats = false; // Счётчики ведутся только после setStatsEnabled(true)
+
+    // Инкрементальное расширение
+    bool incremental = false;
+    uint32_t migrateBatch = 64;        // Ячеек старой таблицы за одну операцию
+    Array<Node, Alloc> oldTable;
+    uint32_t oldTableSize = 0;         // 0 — миграция не идёт
+    uint32_t migrateCursor = 0;        // Первая ещё не перенесённая ячейка
+    uint32_t oldRemaining = 0;         // Элементов осталось в oldTable
+    Array<Node, Alloc> nextTable;      // Заранее строящаяся таблица (только пустые ячейки)
+    uint32_t nextTableSize = 0;        // Её целевой размер; 0 — не строится
+    Array<Node, Alloc> retiredTable;   // Перенесённая старая таблица, разрушается порциями
+
+    // Ближайшая степень двойки, не меньшая n
+    static uint32_t roundUpPow2(uint32_t n) {
+        uint32_t size = 4;
+        while (size < n) {
+            if (size >= (1u << 31)) throw length_error("Error: Hash table size is too large");
+            size <<= 1;
         }
+        return size;
+    }
 
-        // hash(k) = floor(M * ((k * A) mod 1))
-        double temp = numKey * A;
-        temp = temp - floor(temp);   // Получаем дробную часть
-        return static_cast<uint32_t>(floor(tableSize * temp));
+    // Первая хэш-функция: стартовая позиция из младших битов хэша
+    [[nodiscard]] static auto hash1(uint64_t h, uint32_t size) -> uint32_t {
+        return static_cast<uint32_t>(h) & (size - 1);
     }
 
-    // Вторая хэш-функция: метод свёртки
-    [[nodiscard]] auto hash2(const string& key) const -> uint32_t {
-        // Разбиваем ключ на части и складываем
-        uint32_t sum = 0;
-        for (char c : key) {
-            sum += static_cast<uint8_t>(c);
+    // Вторая хэш-функция: шаг из старших битов. Нечётный шаг при размере-степени
+    // двойки гарантирует обход всех ячеек
+    [[nodiscard]] static auto hash2(uint64_t h) -> uint32_t {
+        return static_cast<uint32_t>(h >> 32) | 1;
+    }
+
+    [[nodiscard]] auto migrating() const -> bool {
+        return oldTableSize != 0;
+    }
+
+    // Функция для проверки необходимости расширения таблицы.
+    // Надгробия удлиняют цепочки так же, как живые элементы, поэтому учитываются в загрузке
+    [[nodiscard]] auto needResize() const -> bool {
+        uint64_t used = static_cast<uint64_t>(elementsCount - oldRemaining) + tombstones + 1;
+        return used * 10 > static_cast<uint64_t>(tableSize) * 7;
+    }
+
+    void initTable(uint32_t size) {
+        tableSize = size;
+        // Array(n + 1) уже содержит n пустых ячеек
+        Array<Node, Alloc> fresh(tableSize + 1);
+        fresh.SetSize(tableSize);
+        table.swap(fresh);
+        tombstones = 0;
+    }
+
+    // Позиция ключа в таблице или size, если ключа нет.
+    // Пустая ячейка обрывает цепочку, надгробие — нет
+    // В probes прибавляется число просмотренных ячеек
+    uint32_t locate(const Array<Node, Alloc>& tbl, uint32_t size, LookupKey key, uint64_t h,
+                    uint32_t* probes = nullptr) const {
+        uint32_t h1 = hash1(h, size);
+        uint32_t h2 = hash2(h);
+        uint32_t i = 0;
+        uint32_t result = size;
+        for (; i < size; i++) {
+            uint32_t index = (h1 + i * h2) & (size - 1);
+            const Node& node = tbl[index];
+            if (node.isOccupied) {
+                if (node.hash == h && keyEq(node.first, key)) {
+                    result = index;
+                    break;
+                }
+            } else if (!node.isDeleted) {
+                break;
+            }
         }
+        if (probes) *probes += i < size ? i + 1 : size;
+        return result;
+    }
 
-        // Возвращаем нечётное число
-        uint32_t result = (sum % (tableSize - 1)) + 1;
+    // Ячейка для вставки в table: позиция ключа (found = true)
+    // или первое свободное место на пути пробирования — надгробие либо пустая ячейка
+    uint32_t locateForInsert(LookupKey key, uint64_t h, bool& found, uint32_t* probes = nullptr) const {
+        uint32_t h1 = hash1(h, tableSize);
+        uint32_t h2 = hash2(h);
+        uint32_t firstFree = tableSize;
+        found = false;
+        for (uint32_t i = 0; i < tableSize; i++) {
+            uint32_t index = (h1 + i * h2) & (tableSize - 1);
+            const Node& node = table[index];
+            if (node.isOccupied) {
+                if (node.hash == h && keyEq(node.first, key)) {
+                    found = true;
+                    if (probes) *probes += i + 1;
+                    return index;
+                }
+            } else if (node.isDeleted) {
+                if (firstFree == tableSize) firstFree = index;
+            } else {
+                if (probes) *probes += i + 1;
+                return firstFree != tableSize ? firstFree : index;
+            }
+        }
+        if (probes) *probes += tableSize;
+        if (firstFree != tableSize) return firstFree;
+        // Если мы здесь, значит не удалось вставить элемент (таблица забита или проблема хэш-функции)
+        throw overflow_error("Error: Hash table is full, cannot insert key.");
+    }
 
-        // Делаем результат нечётным, если размер таблицы чётный
-        if (tableSize % 2 == 0 && result % 2 == 0) {
-            result++;
+    // Первое свободное место для ключа, которого заведомо нет в table (перенос при перестройке):
+    // ключи не сравниваются, хэш берётся из узла
+    uint32_t locateFree(uint64_t h) const {
+        uint32_t h1 = hash1(h, tableSize);
+        uint32_t h2 = hash2(h);
+        for (uint32_t i = 0; i < tableSize; i++) {
+            uint32_t index = (h1 + i * h2) & (tableSize - 1);
+            if (!table[index].isOccupied) return index;
         }
+        throw overflow_error("Error: Hash table is full, cannot insert key.");
+    }
 
-        return result;
+    void markDeleted(Node& node) {
+        node.~Node();
+        new (&node) Node();
+        node.isDeleted = true;
     }
 
-    // Функция для проверки необходимости расширения таблицы
-    [[nodiscard]] auto needResize() const -> bool {
-        if (tableSize == 0) return true; // Защита от деления на ноль
-        return (static_cast<double>(elementsCount) / tableSize) > 0.7;
+    // Занимает свободную ячейку table: узел пересоздаётся, значение конструируется
+    // из args на месте, без временного V и присваивания
+    template <typename KeyArg, typename... Args>
+    void place(uint32_t index, uint64_t h, KeyArg&& key, Args&&... args) {
+        Node& node = table[index];
+        bool wasDeleted = node.isDeleted;
+        node.~Node();
+        try {
+            new (&node) Node(piecewise_construct, h, std::forward<KeyArg>(key), std::forward<Args>(args)...);
+        } catch (...) {
+            new (&node) Node();  // Ячейка остаётся свободной
+            node.isDeleted = wasDeleted;
+            throw;
+        }
+        if (wasDeleted) tombstones--;
+    }
+
+    // Перенос одной ячейки старой таблицы в новую
+    void migrateSlot(uint32_t i) {
+        Node& node = oldTable[i];
+        if (!node.isOccupied) return;
+        uint32_t index = locateFree(node.hash);
+        place(index, node.hash, std::move(node.first), std::move(node.second));
+        markDeleted(node);  // Цепочки ещё не перенесённых ключей должны продолжаться
+        oldRemaining--;
+    }
+
+    void endMigration() {
+        Array<Node, Alloc>().swap(oldTable);
+        oldTableSize = 0;
+        migrateCursor = 0;
+        oldRemaining = 0;
+    }
+
+    // Перенос очередной порции ячеек
+    void migrateSome() {
+        uint32_t stop = migrateCursor + migrateBatch;
+        if (stop > oldTableSize || stop < migrateCursor) stop = oldTableSize;
+        for (; migrateCursor < stop; migrateCursor++) {
+            migrateSlot(migrateCursor);
+        }
+        if (migrateCursor == oldTableSize) {
+            // Разрушение всей старой таблицы разом — тот же O(n), что и перехэширование
+            Array<Node, Alloc>().swap(retiredTable);
+            retiredTable.swap(oldTable);
+            endMigration();
+        }
+    }
+
+    void finishMigration() {
+        if (!migrating()) return;
+        for (; migrateCursor < oldTableSize; migrateCursor++) {
+            migrateSlot(migrateCursor);
+        }
+        endMigration();
+    }
+
+    // Если ключ ещё в старой таблице, переносит его в новую
+    void takeFromOld(LookupKey key, uint64_t h) {
+        uint32_t index = locate(oldTable, oldTableSize, key, h);
+        if (index == oldTableSize) return;
+        uint32_t target = locateFree(h);
+        place(target, h, std::move(oldTable[index].first), std::move(oldTable[index].second));
+        markDeleted(oldTable[index]);
+        oldRemaining--;
+    }
+
+    // Размер следующей таблицы. Если заполнение в основном из надгробий, размер
+    // сохраняется, иначе удваивается
+    [[nodiscard]] auto plannedSize() const -> uint32_t {
+        if (static_cast<uint64_t>(elementsCount) * 20 < static_cast<uint64_t>(tableSize) * 7) {
+            return tableSize;
+        }
+        if (tableSize >= (1u << 31)) throw length_error("Error: Hash table size is too large");
+        return tableSize * 2;
+    }
+
+    // Инкрементальный режим: после половины заполнения каждая запись достраивает
+    // следующую таблицу. Память выделяется сразу, а пустые ячейки конструируются
+    // порциями; до порога 0.7 записей хватает, чтобы таблица была готова к расширению
+    void prepareSome() {
+        uint64_t used = static_cast<uint64_t>(elementsCount - oldRemaining) + tombstones + 1;
+        if (used * 2 <= tableSize) return;
+        uint32_t target = plannedSize();
+        if (target != nextTableSize) {
+            Array<Node, Alloc>().swap(nextTable);
+            nextTable.reserve(target);
+            nextTableSize = target;
+        }
+        for (uint32_t i = 0; i < prepareBatch() && nextTable.GetSize() < nextTableSize; i++) {
+            nextTable.emplace_back();
+        }
+    }
+
+    // Новая таблица вдвое больше, а до порога остаётся 0.2 от старой: нужно 10 ячеек за запись
+    [[nodiscard]] auto prepareBatch() const -> uint32_t {
+        return migrateBatch < 16 ? 16 : migrateBatch;
+    }
+
+    // Фоновая работа операции записи: перенос старой таблицы, разрушение
+    // перенесённой и постройка следующей
+    void advanceResize() {
+        if (migrating()) {
+            migrateSome();
+            return;
+        }
+        if (!incremental) return;
+        uint64_t retired = retiredTable.GetSize();
+        if (retired > prepareBatch()) {
+            retiredTable.SetSize(retired - prepareBatch());
+        } else if (retiredTable.GetCapacity() != 0) {
+            Array<Node, Alloc>().swap(retiredTable);
+        }
+        prepareSome();
     }
 
-    // Расширение таблицы при достижении порога загрузки
     void resize() {
-        uint32_t oldSize = tableSize;
-        Array<HashNode<T>> oldTable = table;
+        rehashTo(plannedSize());
+    }
 
-        // Увеличиваем размер таблицы
-        // Делаем нечётным для лучшего распределения
-        tableSize = tableSize * 2 + 1;
+    // Перенос всех элементов в таблицу размера newSize (узлы перемещаются, а не копируются)
+    // Время учитывается в статистике; в инкрементальном режиме — только запуск миграции
+    void rehashTo(uint32_t newSize) {
+        auto started = collectStats ? chrono::steady_clock::now() : chrono::steady_clock::time_point();
+        finishMigration();
+        oldTable.swap(table);
+        oldTableSize = tableSize;
+        migrateCursor = 0;
+        oldRemaining = elementsCount;
+        if (nextTableSize == newSize) {
+            // Заранее построенная таблица: досоздаются только оставшиеся ячейки
+            nextTable.SetSize(newSize);
+            table.swap(nextTable);
+            Array<Node, Alloc>().swap(nextTable);
+            nextTableSize = 0;
+            tableSize = newSize;
+            tombstones = 0;
+        } else {
+            initTable(newSize);
+        }
 
-        // Создаём новую таблицу
-        table = Array<HashNode<T>>(tableSize + 1);
-        for (uint32_t i = 0; i < tableSize; i++) {
-            table[i] = HashNode<T>();
+        if (!incremental) {
+            finishMigration();
+        }
+        if (collectStats) {
+            counters.resizes++;
+            counters.resizeNanos += static_cast<uint64_t>(
+                chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - started).count());
         }
-        table.SetSize(tableSize);
+    }
 
-        elementsCount = 0;
+    // Куда считать пробирования операции: nullptr, если статистика выключена
+    uint32_t* probeCounter(uint32_t& probes) const {
+        return collectStats ? &probes : nullptr;
+    }
 
-        // Перехэшируем все элементы
-        for (uint32_t i = 0; i < oldSize; i++) {
-            if (oldTable[i].isOccupied) {
-                insert(oldTable[i].first, oldTable[i].second);
-            }
+    void recordProbes(uint64_t (&histogram)[HashStats::Buckets], uint32_t probes) {
+        if (collectStats) HashStats::record(histogram, probes, counters.maxProbe);
+    }
+
+    // Поиск или вставка за одно пробирование: locateForInsert сразу даёт либо
+    // позицию ключа, либо свободную ячейку. Повторное пробирование — только после расширения.
+    // Возвращает позицию и признак того, что элемент вставлен
+    template <typename KeyArg, typename... Args>
+    auto emplaceImpl(KeyArg&& key, Args&&... args) -> pair<uint32_t, bool> {
+        if (tableSize == 0) initTable(4);  // Таблица, из которой перемещали
+        uint64_t h = hasher(key);
+        advanceResize();
+        if (migrating()) takeFromOld(key, h);
+
+        bool found = false;
+        uint32_t probes = 0;
+        uint32_t index = locateForInsert(key, h, found, probeCounter(probes));
+        if (found) {
+            recordProbes(counters.insertProbes, probes);
+            return {index, false};
+        }
+
+        if (needResize()) {
+            resize();
+            probes = 0;
+            index = locateForInsert(key, h, found, probeCounter(probes));
+        }
+        recordProbes(counters.insertProbes, probes);
+        place(index, h, std::forward<KeyArg>(key), std::forward<Args>(args)...);
+        elementsCount++;
+        return {index, true};
+    }
+
+    template <typename KeyArg, typename M>
+    auto assignImpl(KeyArg&& key, M&& value) -> pair<uint32_t, bool> {
+        auto result = emplaceImpl(std::forward<KeyArg>(key), std::forward<M>(value));
+        // Если ключ уже существует, обновляем значение (value ещё не был использован)
+        if (!result.second) table[result.first].second = std::forward<M>(value);
+        return result;
+    }
+
+    // Обход всех элементов, включая ещё не перенесённые
+    template <typename F>
+    void forEachNode(F&& f) const {
+        for (uint32_t i = 0; i < tableSize; i++) {
+            if (table[i].isOccupied) f(i, table[i]);
+        }
+        for (uint32_t i = migrateCursor; i < oldTableSize; i++) {
+            if (oldTable[i].isOccupied) f(i, oldTable[i]);
         }
     }
 
  public:
     struct Iterator {
-        Array<HashNode<T>>* tableRef;
+        Array<Node, Alloc>* tableRef;
         uint32_t index;
         uint32_t totalSize;
 
-        Iterator(Array<HashNode<T>>* tbl, uint32_t startIdx, uint32_t size) : tableRef(tbl)
+        Iterator(Array<Node, Alloc>* tbl, uint32_t startIdx, uint32_t size) : tableRef(tbl)
                                                                             , index(startIdx)
                                                                             , totalSize(size) {
             // Проматываем пустые ячейки при создании, если мы не в конце
@@ -115,8 +601,8 @@ class DoubleHash {
         }
 
         // Разыменование возвращает HashNode&, у которого есть поля first и second
-        HashNode<T>& operator*() { return (*tableRef)[index]; }
-        HashNode<T>* operator->() { return &((*tableRef)[index]); }
+        Node& operator*() { return (*tableRef)[index]; }
+        Node* operator->() { return &((*tableRef)[index]); }
 
         Iterator& operator++() {
             do {
@@ -134,188 +620,312 @@ class DoubleHash {
         }
     };
 
-    Iterator begin() { return Iterator(&table, 0, tableSize); }
+    // Обход идёт по одной таблице, поэтому незавершённая миграция доводится до конца
+    Iterator begin() {
+        finishMigration();
+        return Iterator(&table, 0, tableSize);
+    }
 
     Iterator end() { return Iterator(&table, tableSize, tableSize); }
 
     // Конструктор
-    explicit DoubleHash(uint32_t size = 3) : tableSize(size)
-                                    , elementsCount(0)
-                                    , table(Array<HashNode<T>>(size + 1)) {
+    explicit BasicDoubleHash(uint32_t size = 3, const Hash& hashFunc = Hash()) : tableSize(0)
+                                                                          , elementsCount(0)
+                                                                          , tombstones(0)
+                                                                          , hasher(hashFunc) {
         if (size == 0) {
             throw invalid_argument("Table size cannot be zero");
         }
-        for (uint32_t i = 0; i < tableSize; i++) {
-            table[i] = HashNode<T>();
-        }
-        table.SetSize(tableSize);
+        initTable(roundUpPow2(size));
     }
 
     // Деструктор
-    ~DoubleHash() {
+    ~BasicDoubleHash() {
         // Array имеет свой деструктор, который освободит память
     }
 
-    // Копирующий конструктор
-    DoubleHash(const DoubleHash<T>& other) : tableSize(other.tableSize)
-                            , elementsCount(other.elementsCount)
-                            , table(Array<HashNode<T>>(other.tableSize + 1)) {
-        // Копируем все элементы таблицы
-        for (uint32_t i = 0; i < tableSize; i++) {
-            table[i] = other.table[i];
+    // Копирующий конструктор: копируется и состояние незавершённой миграции
+    BasicDoubleHash(const BasicDoubleHash& other) : table(other.table)
+                                        , tableSize(other.tableSize)
+                                        , elementsCount(other.elementsCount)
+                                        , tombstones(other.tombstones)
+                                        , hasher(other.hasher)
+                                        , keyEq(other.keyEq)
+                                        , counters(other.counters)
+                                        , collectStats(other.collectStats)
+                                        , incremental(other.incremental)
+                                        , migrateBatch(other.migrateBatch)
+                                        , oldTable(other.oldTable)
+                                        , oldTableSize(other.oldTableSize)
+                                        , migrateCursor(other.migrateCursor)
+                                        , oldRemaining(other.oldRemaining) {}
+
+    // Перемещающий конструктор: таблицы забираются без копирования узлов.
+    // other остаётся пустой таблицей без памяти; первая вставка выделит её заново
+    BasicDoubleHash(BasicDoubleHash&& other) noexcept : tableSize(0)
+                                            , elementsCount(0)
+                                            , tombstones(0)
+                                            , hasher(other.hasher)
+                                            , keyEq(other.keyEq) {
+        swap(other);
+    }
+
+    // Перемещающий оператор присваивания
+    auto operator=(BasicDoubleHash&& other) noexcept -> BasicDoubleHash& {
+        if (this != &other) {
+            swap(other);
         }
-        table.SetSize(tableSize);
+        return *this;
+    }
+
+    void swap(BasicDoubleHash& other) noexcept {
+        table.swap(other.table);
+        std::swap(tableSize, other.tableSize);
+        std::swap(elementsCount, other.elementsCount);
+        std::swap(tombstones, other.tombstones);
+        std::swap(hasher, other.hasher);
+        std::swap(keyEq, other.keyEq);
+        std::swap(counters, other.counters);
+        std::swap(collectStats, other.collectStats);
+        std::swap(incremental, other.incremental);
+        std::swap(migrateBatch, other.migrateBatch);
+        oldTable.swap(other.oldTable);
+        std::swap(oldTableSize, other.oldTableSize);
+        std::swap(migrateCursor, other.migrateCursor);
+        std::swap(oldRemaining, other.oldRemaining);
+        nextTable.swap(other.nextTable);
+        std::swap(nextTableSize, other.nextTableSize);
+        retiredTable.swap(other.retiredTable);
     }
 
     // Копирующий оператор присваивания
-    auto operator=(const DoubleHash<T>& other) -> DoubleHash<T>& {
+    auto operator=(const BasicDoubleHash& other) -> BasicDoubleHash& {
         // Защита от самоприсваивания
         if (this == &other) {
             return *this;
         }
 
         // Копируем данные из other
+        table = other.table;
         tableSize = other.tableSize;
         elementsCount = other.elementsCount;
-
-        // Создаём новую таблицу нужного размера
-        table = Array<HashNode<T>>(tableSize + 1);
-
-        // Копируем все элементы
-        for (uint32_t i = 0; i < tableSize; i++) {
-            table[i] = other.table[i];
-        }
-        table.SetSize(tableSize);
+        tombstones = other.tombstones;
+        hasher = other.hasher;
+        keyEq = other.keyEq;
+        counters = other.counters;
+        collectStats = other.collectStats;
+        incremental = other.incremental;
+        migrateBatch = other.migrateBatch;
+        oldTable = other.oldTable;
+        oldTableSize = other.oldTableSize;
+        migrateCursor = other.migrateCursor;
+        oldRemaining = other.oldRemaining;
+        Array<Node, Alloc>().swap(nextTable);
+        nextTableSize = 0;
 
         return *this;
     }
 
-    T& operator[](const string& key) {
-        Iterator it = find(key);
-        if (it != end()) {
-            return it->second;
+    // Включение инкрементального расширения: вместо полного перехэширования
+    // каждая операция записи переносит не более bucketsPerOp ячеек старой таблицы
+    // и достраивает следующую таблицу не более чем на max(bucketsPerOp, 16) ячеек
+    void setIncrementalResize(bool enabled, uint32_t bucketsPerOp = 64) {
+        if (bucketsPerOp == 0) {
+            throw invalid_argument("Migration batch cannot be zero");
         }
-        // Если элемента нет, вставляем пустой и возвращаем ссылку на него
-        insert(key, T());
-        return find(key)->second;
+        if (!enabled) finishMigration();
+        incremental = enabled;
+        migrateBatch = bucketsPerOp;
     }
 
-    // Вставка элемента
-    void insert(const string& key, const T& value) {
-        if (needResize()) {
-            resize();
-        }
-
-        uint32_t h1 = hash1(key);
-        uint32_t h2 = hash2(key);
-        uint32_t i = 0;
+    // Идёт ли перенос старой таблицы
+    [[nodiscard]] auto isResizing() const -> bool {
+        return migrating();
+    }
 
-        while (i < tableSize) {
-            uint32_t index = (h1 + i * h2) % tableSize;
+    // Ссылка на значение; если ключа нет, вставляется V() — за одно пробирование
+    V& operator[](const K& key) {
+        return table[emplaceImpl(key).first].second;
+    }
 
-            // Если ячейка свободна или была удалена, вставляем
-            if (!table[index].isOccupied) {
-                table[index] = HashNode<T>(key, value);
-                elementsCount++;
-                return;
-            }
+    V& operator[](K&& key) {
+        return table[emplaceImpl(std::move(key)).first].second;
+    }
 
-            // Если ключ уже существует, обновляем значение
-            if (table[index].first == key) {
-                table[index].second = value;
-                return;
-            }
+    // Вставка, только если ключа ещё нет; значение конструируется на месте из args
+    template <typename... Args>
+    auto try_emplace(const K& key, Args&&... args) -> pair<Iterator, bool> {
+        auto [index, inserted] = emplaceImpl(key, std::forward<Args>(args)...);
+        return {Iterator(&table, index, tableSize), inserted};
+    }
 
-            i++;
-        }
+    template <typename... Args>
+    auto try_emplace(K&& key, Args&&... args) -> pair<Iterator, bool> {
+        auto [index, inserted] = emplaceImpl(std::move(key), std::forward<Args>(args)...);
+        return {Iterator(&table, index, tableSize), inserted};
+    }
 
-        // Если мы здесь, значит не удалось вставить элемент (таблица забита или проблема хэш-функции)
-        throw overflow_error("Error: Hash table is full, cannot insert key.");
+    // Вставка или обновление значения за одно пробирование
+    template <typename M>
+    auto insert_or_assign(const K& key, M&& value) -> pair<Iterator, bool> {
+        auto [index, inserted] = assignImpl(key, std::forward<M>(value));
+        return {Iterator(&table, index, tableSize), inserted};
     }
 
-    // Поиск элемента по ключу
-    auto find(const string& key) -> Iterator {
-        if (elementsCount == 0) return end();
+    template <typename M>
+    auto insert_or_assign(K&& key, M&& value) -> pair<Iterator, bool> {
+        auto [index, inserted] = assignImpl(std::move(key), std::forward<M>(value));
+        return {Iterator(&table, index, tableSize), inserted};
+    }
 
-        uint32_t h1 = hash1(key);
-        uint32_t h2 = hash2(key);
-        uint32_t i = 0;
+    // Вставка элемента; если ключ уже есть, значение обновляется
+    void insert(const K& key, const V& value) {
+        assignImpl(key, value);
+    }
 
-        while (i < tableSize) {
-            uint32_t index = (h1 + i * h2) % tableSize;
+    void insert(K&& key, V&& value) {
+        assignImpl(std::move(key), std::move(value));
+    }
 
-            // Если ячейка никогда не использовалась, элемента нет
-            if (!table[index].isOccupied) {
-                return end();
-            }
+    // Заранее расширяет таблицу так, чтобы n элементов поместились без перестроек
+    void reserve(uint32_t n) {
+        uint64_t needed = static_cast<uint64_t>(n) * 10 / 7 + 1;
+        if (needed > (1u << 31)) throw length_error("Error: Hash table size is too large");
+        uint32_t newSize = roundUpPow2(static_cast<uint32_t>(needed));
+        if (newSize > tableSize) rehashTo(newSize);
+    }
 
-            // Если нашли ключ и элемент не удалён
-            if (table[index].first == key && table[index].isOccupied) {
-                return Iterator(&table, index, tableSize);
-            }
+    // Поиск элемента по ключу. Принимает string, string_view и строковые литералы
+    // без создания временной std::string
+    auto find(LookupKey key) -> Iterator {
+        if (elementsCount == 0) return end();
 
-            i++;
+        uint64_t h = hasher(key);
+        uint32_t probes = 0;
+        uint32_t index = locate(table, tableSize, key, h, probeCounter(probes));
+        if (index == tableSize && migrating()) {
+            // Ключ из старой таблицы сразу переносится, чтобы итератор указывал в table
+            takeFromOld(key, h);
+            index = locate(table, tableSize, key, h);
         }
-
-        return end();
+        recordProbes(counters.findProbes, probes);
+        if (index == tableSize) return end();
+        return Iterator(&table, index, tableSize);
     }
 
-    // Удаление элемента
-    auto remove(const string& key) -> bool {
-        if (elementsCount == 0) return false;
+    // Поиск без изменения таблицы: миграция не продвигается, поэтому метод
+    // можно вызывать из нескольких потоков над неизменяемым снимком.
+    // Возвращает указатель на значение или nullptr. Счётчики таблицы не меняются:
+    // число пробирований прибавляется к probes, учёт ведёт вызывающий
+    auto get(LookupKey key, uint32_t* probes = nullptr) const -> const V* {
+        if (elementsCount == 0) return nullptr;
+
+        uint64_t h = hasher(key);
+        uint32_t index = locate(table, tableSize, key, h, probes);
+        if (index != tableSize) return &table[index].second;
+        if (migrating()) {
+            index = locate(oldTable, oldTableSize, key, h, probes);
+            if (index != oldTableSize) return &oldTable[index].second;
+        }
+        return nullptr;
+    }
 
-        uint32_t h1 = hash1(key);
-        uint32_t h2 = hash2(key);
-        uint32_t i = 0;
+    // Обход пар ключ-значение без изменения таблицы: f(key, value)
+    template <typename F>
+    void forEach(F&& f) const {
+        forEachNode([&f](uint32_t, const Node& node) { f(node.first, node.second); });
+    }
 
-        while (i < tableSize) {
-            uint32_t index = (h1 + i * h2) % tableSize;
+    // Поиск по указателю и длине, например по срезу буфера (только строковые ключи)
+    template <typename KeyT = K, typename = enable_if_t<is_same_v<KeyT, string>>>
+    auto find(const char* key, size_t length) -> Iterator {
+        return find(string_view(key, length));
+    }
 
-            if (!table[index].isOccupied) {
-                return false;
-            }
+    // Удаление элемента: на месте ключа остаётся надгробие, цепочки не рвутся
+    auto remove(LookupKey key) -> bool {
+        if (elementsCount == 0) return false;
+        advanceResize();
+
+        uint64_t h = hasher(key);
+        uint32_t probes = 0;
+        uint32_t index = locate(table, tableSize, key, h, probeCounter(probes));
+        if (index != tableSize) {
+            recordProbes(counters.removeProbes, probes);
+            markDeleted(table[index]);
+            tombstones++;
+            elementsCount--;
+            return true;
+        }
 
-            if (table[index].first == key && table[index].isOccupied) {
-                table[index].isOccupied = false;
+        if (migrating()) {
+            index = locate(oldTable, oldTableSize, key, h, probeCounter(probes));
+        }
+        recordProbes(counters.removeProbes, probes);
+        if (migrating()) {
+            if (index != oldTableSize) {
+                markDeleted(oldTable[index]);
+                oldRemaining--;
                 elementsCount--;
                 return true;
             }
-
-            i++;
         }
 
         return false;
     }
 
+    // Статистика: счётчики операций и текущее заполнение обеих таблиц
+    [[nodiscard]] auto stats() const -> HashStats {
+        HashStats result = counters;
+        result.elements = elementsCount;
+        result.capacity = static_cast<uint64_t>(tableSize) + oldTableSize;
+        result.tombstones = tombstones;
+        return result;
+    }
+
+    void resetStats() {
+        counters = HashStats();
+    }
+
+    // Статистика выключена по умолчанию: гистограммы пишутся на каждой операции
+    void setStatsEnabled(bool enabled) {
+        collectStats = enabled;
+    }
+
+    [[nodiscard]] auto statsEnabled() const -> bool {
+        return collectStats;
+    }
+
     // Печать таблицы
     void print() const {
         cout << "=== Хэш-таблица ===" << endl;
         cout << "Размер: " << tableSize
         << ", Элементов: " << elementsCount << endl;
-        for (uint32_t i = 0; i < tableSize; i++) {
-            if (table[i].isOccupied) {
-                cout << "[" << i << "] " << table[i].first << " => " << table[i].second << endl;
-            }
-        }
+        forEachNode([](uint32_t i, const Node& node) {
+            cout << "[" << i << "] " << node.first << " => " << node.second << endl;
+        });
         cout << "===================" << endl;
     }
     
     // Сериализация в текстовом формате
     void serialize_text(const string& filename) const {
-        ofstream outFile(filename);
-        if (!outFile.is_open()) {
-            throw runtime_error("Error: Could not open file for writing: " + filename);
-        }
+        TextWriter outFile(filename);
 
         // Записываем заголовок
-        outFile << tableSize << " " << elementsCount << endl;
+        outFile.value(tableSize);
+        outFile.put(' ');
+        outFile.value(elementsCount);
+        outFile.put('\n');
 
         // Записываем только занятые ячейки
-        for (uint32_t i = 0; i < tableSize; i++) {
-            if (table[i].isOccupied) {
-                outFile << i << " " << table[i].first << " " << table[i].second << endl;
-            }
-        }
+        forEachNode([&outFile](uint32_t i, const Node& node) {
+            outFile.value(i);
+            outFile.put(' ');
+            outFile.value(node.first);
+            outFile.put(' ');
+            outFile.value(node.second);
+            outFile.put('\n');
+        });
 
         outFile.close();
         cout << "Таблица (текст) успешно сохранена в " << filename << endl;
@@ -323,58 +933,55 @@ class DoubleHash {
 
     // Десериализация из текстового формата
     void deserialize_text(const string& filename) {
-        ifstream inFile(filename);
-        if (!inFile.is_open()) {
-            throw runtime_error("Error: Could not open file for reading: " + filename);
-        }
+        TextReader inFile(filename);
 
         uint32_t newTableSize = 0;
         uint32_t newElementsCount = 0;
 
         // Читаем заголовок
-        inFile >> newTableSize >> newElementsCount;
-        if (newTableSize == 0)
+        if (!inFile.value(newTableSize) || !inFile.value(newElementsCount) || newTableSize == 0)
             throw runtime_error("Could not read data from file. Size of table equal to zero");
 
-        // Пересоздаем таблицу
+        // Пересоздаем таблицу. Ключи вставляются заново, поэтому размер из заголовка
+        // ограничивается тем, сколько записей (минимум 6 байт) помещается в остатке файла
+        uint64_t fits = inFile.remaining() / 6 * 10 / 7 + 1;
         try {
-            table = Array<HashNode<T>>(newTableSize + 1);
-            for (uint32_t i = 0; i < newTableSize; i++) {
-                table[i] = HashNode<T>();
-            }
-            table.SetSize(newTableSize);
+            endMigration();
+            initTable(roundUpPow2(newTableSize < fits ? newTableSize : static_cast<uint32_t>(fits)));
         } catch (...) {
             throw runtime_error("Error: Memory allocation failed during deserialization");
         }
-
-        tableSize = newTableSize;
-        elementsCount = newElementsCount;
+        elementsCount = 0;
 
         // Читаем данные
         uint32_t idx;
-        string key;
-        T value;
+        K key;
+        V value;
 
-        // Читаем данные
-        while (inFile >> idx >> key >> value) {
-            
-            if (inFile.fail()) {
+        // Позиция из файла зависит от хэш-функции, которой файл был записан,
+        // поэтому ключи вставляются заново
+        while (inFile.more()) {
+            if (!inFile.value(idx) || !inFile.value(key) || !inFile.value(value)) {
                  throw runtime_error("Error: Corrupted data in file: " + filename);
             }
 
-            if (idx >= tableSize) {
+            if (idx >= newTableSize) {
                 throw out_of_range("Error: Index in file (" + to_string(idx) + 
-                                        ") exceeds table size (" + to_string(tableSize) + ")");
+                                        ") exceeds table size (" + to_string(newTableSize) + ")");
             }
-            table[idx] = HashNode<T>(key, value);
+            insert(std::move(key), std::move(value));
+        }
+
+        if (elementsCount != newElementsCount) {
+            throw runtime_error("Error: Corrupted data in file: " + filename);
         }
 
-        inFile.close();
         cout << "Таблица (текст) успешно загружена из " << filename << endl;
     }
 
     // Сериализация в бинарном формате
     void serialize_bin(const string& filename) const {
+        static_assert(is_trivially_copyable_v<V>, "Binary format stores values as raw bytes");
         ofstream outFile(filename, ios::binary);
         if (!outFile.is_open()) {
             throw runtime_error("Error: Could not open binary file for writing: " + filename);
@@ -384,21 +991,30 @@ class DoubleHash {
         outFile.write(reinterpret_cast<const char*>(&tableSize), sizeof(tableSize));
         outFile.write(reinterpret_cast<const char*>(&elementsCount), sizeof(elementsCount));
 
-        for (uint32_t i = 0; i < tableSize; i++) {
-            bool occupied = table[i].isOccupied;
+        // Сначала занятые ячейки (включая ещё не перенесённые), затем пустые до tableSize:
+        // при загрузке ключи вставляются заново, позиции не важны
+        forEachNode([&outFile](uint32_t, const Node& node) {
+            bool occupied = true;
             outFile.write(reinterpret_cast<const char*>(&occupied), sizeof(bool));
 
-            if (occupied) {
+            if constexpr (is_same_v<K, string>) {
                 // Записываем длину ключа
-                uint32_t keyLen = static_cast<uint32_t>(table[i].first.size());
+                uint32_t keyLen = static_cast<uint32_t>(node.first.size());
                 outFile.write(reinterpret_cast<const char*>(&keyLen), sizeof(keyLen));
 
                 // Записываем сам ключ
-                outFile.write(table[i].first.c_str(), keyLen);
-
-                // Записываем значение
-                outFile.write(reinterpret_cast<const char*>(&table[i].second), sizeof(T));
+                outFile.write(node.first.c_str(), keyLen);
+            } else {
+                // Тривиально копируемый ключ пишется как есть
+                outFile.write(reinterpret_cast<const char*>(&node.first), sizeof(K));
             }
+
+            // Записываем значение
+            outFile.write(reinterpret_cast<const char*>(&node.second), sizeof(V));
+        });
+        for (uint32_t i = elementsCount; i < tableSize; i++) {
+            bool occupied = false;
+            outFile.write(reinterpret_cast<const char*>(&occupied), sizeof(bool));
         }
 
         outFile.close();
@@ -407,6 +1023,7 @@ class DoubleHash {
 
     // Десериализация из бинарного формата
     void deserialize_bin(const string& filename) {
+        static_assert(is_trivially_copyable_v<V>, "Binary format stores values as raw bytes");
         ifstream inFile(filename, ios::binary);
         if (!inFile.is_open()) {
             throw runtime_error("Error: Could not open binary file for reading: " + filename);
@@ -419,17 +1036,27 @@ class DoubleHash {
         inFile.read(reinterpret_cast<char*>(&newTableSize), sizeof(newTableSize));
         inFile.read(reinterpret_cast<char*>(&newElementsCount), sizeof(newElementsCount));
 
-        table = Array<HashNode<T>>(newTableSize + 1);
-        for (uint32_t i = 0; i < newTableSize; i++) {
-            table[i] = HashNode<T>();
+        if (inFile.fail() || newTableSize == 0) {
+            throw runtime_error("Error: Could not read table header from " + filename);
         }
-        table.SetSize(newTableSize);
 
-        tableSize = newTableSize;
-        elementsCount = newElementsCount;
+        // Каждая ячейка занимает в файле хотя бы байт признака, поэтому размер
+        // из заголовка ограничивается остатком файла
+        streampos dataStart = inFile.tellg();
+        inFile.seekg(0, ios::end);
+        uint64_t fits = static_cast<uint64_t>(inFile.tellg() - dataStart);
+        inFile.seekg(dataStart);
+        try {
+            endMigration();
+            initTable(roundUpPow2(newTableSize < fits ? newTableSize : static_cast<uint32_t>(fits)));
+        } catch (...) {
+            throw runtime_error("Error: Memory allocation failed during deserialization");
+        }
+        elementsCount = 0;
 
-        // Читаем данные ячеек
-        for (uint32_t i = 0; i < tableSize; i++) {
+        // Читаем данные ячеек. Ключи вставляются заново: позиции в файле
+        // зависят от хэш-функции, которой он был записан
+        for (uint32_t i = 0; i < newTableSize; i++) {
             bool occupied = false;
             inFile.read(reinterpret_cast<char*>(&occupied), sizeof(bool));
 
@@ -438,41 +1065,47 @@ class DoubleHash {
             }
 
             if (occupied) {
-                // Читаем длину ключа
-                uint32_t keyLen = 0;
-                inFile.read(reinterpret_cast<char*>(&keyLen), sizeof(keyLen));
-
-                // Защита от переполнения памяти при чтении длины строки
-                if (keyLen > 1000000) { // Разумный лимит
-                    throw length_error("Error: Key length in file seems too large (corrupted file?)");
-                }
-
-                char* keyBuf = new char[keyLen + 1];
-                inFile.read(keyBuf, keyLen);
-                
-                if (inFile.fail()) {
-                    delete[] keyBuf;
-                    throw runtime_error("Error: Failed to read key string");
+                K loadedKey;
+                if constexpr (is_same_v<K, string>) {
+                    // Читаем длину ключа
+                    uint32_t keyLen = 0;
+                    inFile.read(reinterpret_cast<char*>(&keyLen), sizeof(keyLen));
+
+                    // Защита от переполнения памяти при чтении длины строки
+                    if (keyLen > 1000000) { // Разумный лимит
+                        throw length_error("Error: Key length in file seems too large (corrupted file?)");
+                    }
+
+                    // Ключ читается сразу в строку, без промежуточного буфера
+                    loadedKey.resize(keyLen);
+                    inFile.read(loadedKey.data(), keyLen);
+
+                    if (inFile.fail()) {
+                        throw runtime_error("Error: Failed to read key string");
+                    }
+                } else {
+                    inFile.read(reinterpret_cast<char*>(&loadedKey), sizeof(K));
+                    if (inFile.fail()) {
+                        throw runtime_error("Error: Failed to read key");
+                    }
                 }
-                
-                keyBuf[keyLen] = '\0';
-                string loadedKey(keyBuf);
-                delete[] keyBuf;
 
                 // Читаем значение
-                T loadedValue;
-                inFile.read(reinterpret_cast<char*>(&loadedValue), sizeof(T));
+                V loadedValue;
+                inFile.read(reinterpret_cast<char*>(&loadedValue), sizeof(V));
 
                 if (inFile.fail()) {
                     throw runtime_error("Error: Failed to read value");
                 }
 
-                table[i] = HashNode<T>(loadedKey, loadedValue);
-            } else {
-                table[i].isOccupied = false;
+                insert(std::move(loadedKey), std::move(loadedValue));
             }
         }
 
+        if (elementsCount != newElementsCount) {
+            throw runtime_error("Error: Element count mismatch in " + filename);
+        }
+
         inFile.close();
         cout << "Таблица (бинарн.) успешно загружена из " << filename << endl;
     }
@@ -489,11 +1122,14 @@ class DoubleHash {
 
     // Очистка таблицы
     void clear() {
-        for (uint32_t i = 0; i < tableSize; i++) {
-            table[i] = HashNode<T>();
-        }
+        endMigration();
+        initTable(tableSize);
         elementsCount = 0;
     }
 };
 
+// Таблица со строковыми ключами
+template <typename T, typename Hash = DefaultHash<string>, typename Alloc = HeapAllocator>
+using DoubleHash = BasicDoubleHash<string, T, Hash, equal_to<>, Alloc>;
+
 #endif   // DH_HPP
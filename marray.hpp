@@ -0,0 +1,82 @@
+#ifndef MARRAY_HPP
+#define MARRAY_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+#include "array.hpp"
+#include "mmap.hpp"
+
+using namespace std;
+
+// Массив только для чтения поверх отображённого файла, записанного
+// Array::MSAVE_BINARY. Открытие проверяет заголовок за O(1) и не копирует
+// данные, поэтому время загрузки не зависит от размера. Контрольная сумма
+// проверяется только по запросу (verify): она требует чтения всего файла
+template <typename T>
+class MappedArray {
+    static_assert(is_trivially_copyable_v<T>, "Mapped arrays require a trivially copyable T");
+    static_assert(alignof(T) <= sizeof(ArrayFileHeader), "Element alignment must not exceed the data offset");
+
+ public:
+    using size_type = uint64_t;
+    using iterator = const T*;
+    using const_iterator = const T*;
+
+ private:
+    MappedFile file;
+    const ArrayFileHeader* header;
+    const T* data;
+    size_type size;
+
+ public:
+    explicit MappedArray(const string& filename) : file(filename), header(nullptr), data(nullptr), size(0) {
+        if (file.size() < sizeof(ArrayFileHeader)) {
+            throw runtime_error("Error: File is too small for a binary array: " + filename);
+        }
+        header = reinterpret_cast<const ArrayFileHeader*>(file.data());
+        if (memcmp(header->magic, ArrayFileMagic, sizeof(header->magic)) != 0) {
+            throw runtime_error("Error: Not a binary array file: " + filename);
+        }
+        Array<T>::checkBinaryHeader(*header, file.size(), filename);
+        data = reinterpret_cast<const T*>(file.data() + header->dataOffset);
+        size = header->count;
+    }
+
+    // Сверка данных с контрольной суммой заголовка
+    [[nodiscard]] auto verify() const -> bool {
+        return arrayChecksum(data, sizeof(T) * size) == header->checksum;
+    }
+
+    const_iterator begin() const { return data; }
+    const_iterator end() const { return data + size; }
+
+    auto operator[](size_type index) const -> const T& {
+        if (index >= size) {
+            throw out_of_range("Error: Index " + to_string(index)
+            + " is out of bounds (size " + to_string(size) + ").");
+        }
+        return data[index];
+    }
+
+    auto MGET_BY_IND(size_type index) const -> const T& {
+        return (*this)[index];
+    }
+
+    const T& back() const {
+        if (size == 0) throw out_of_range("Array is empty");
+        return data[size - 1];
+    }
+
+    bool empty() const {
+        return size == 0;
+    }
+
+    [[nodiscard]] auto GetSize() const -> size_type {
+        return size;
+    }
+};
+
+#endif   // MARRAY_HPP
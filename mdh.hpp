@@ -0,0 +1,231 @@
+#ifndef MDH_HPP
+#define MDH_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include "array.hpp"
+#include "dh.hpp"
+#include "mmap.hpp"
+
+using namespace std;
+
+// Формат хэш-таблицы на диске, пригодный для отображения в память:
+//   [MappedHashHeader][slotCount × MappedSlot<V>][куча ключей]
+// Ячейки фиксированной ширины расположены так же, как в BasicDoubleHash
+// (двойное хэширование, размер — степень двойки), ключи лежат в куче и
+// адресуются смещением. Файл открывается за O(1) и читается без десериализации.
+// Числа хранятся в порядке байтов машины, byteOrder позволяет это проверить
+constexpr char MappedHashMagic[4] = {'D', 'H', 'M', 'P'};
+constexpr uint32_t MappedHashVersion = 1;
+constexpr uint32_t MappedHashByteOrder = 0x01020304;
+
+struct MappedHashHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t keySize;       // 0 — строковые ключи переменной длины
+    uint32_t valueSize;
+    uint32_t slotSize;
+    uint32_t slotCount;     // Степень двойки
+    uint32_t elements;
+    uint64_t heapOffset;
+    uint64_t heapSize;
+    uint64_t hashCheck;     // Хэш пустого ключа: проверка, что хэш-функция та же
+    uint64_t reserved;
+};
+
+static_assert(sizeof(MappedHashHeader) == 64, "Header layout must stay fixed");
+
+template <typename V>
+struct MappedSlot {
+    uint64_t hash;          // Полный хэш: сравнивается раньше ключа
+    uint64_t keyOffset;     // Смещение ключа от начала кучи
+    uint32_t keyLength;
+    uint32_t occupied;
+    V value;
+};
+
+// Запись таблицы в отображаемый формат. Значения и нестроковые ключи
+// должны быть тривиально копируемыми: они пишутся как есть
+template <typename K, typename V, typename Hash, typename Eq, typename Alloc>
+void writeMappedHash(const BasicDoubleHash<K, V, Hash, Eq, Alloc>& source, const string& filename,
+                     const Hash& hasher = Hash()) {
+    static_assert(is_trivially_copyable_v<V>, "Mapped hash values must be trivially copyable");
+    static_assert(is_same_v<K, string> || is_trivially_copyable_v<K>,
+                  "Mapped hash keys must be std::string or trivially copyable");
+    static_assert(alignof(MappedSlot<V>) <= alignof(MappedHashHeader),
+                  "Slot alignment must not exceed header alignment");
+
+    uint64_t needed = static_cast<uint64_t>(source.size()) * 10 / 7 + 1;
+    uint32_t slotCount = 4;
+    while (slotCount < needed) {
+        if (slotCount >= (1u << 31)) throw length_error("Error: Hash table size is too large");
+        slotCount <<= 1;
+    }
+
+    Array<MappedSlot<V>> slots(slotCount + 1);
+    slots.SetSize(slotCount);
+    memset(static_cast<void*>(slots.begin()), 0, sizeof(MappedSlot<V>) * slotCount);
+    string heap;
+
+    // Размещение тем же двойным хэшированием, что и в BasicDoubleHash
+    source.forEach([&](const K& key, const V& value) {
+        uint64_t h = hasher(key);
+        uint32_t step = static_cast<uint32_t>(h >> 32) | 1;
+        uint32_t index = static_cast<uint32_t>(h) & (slotCount - 1);
+        while (slots[index].occupied) index = (index + step) & (slotCount - 1);
+
+        MappedSlot<V>& slot = slots[index];
+        slot.hash = h;
+        slot.keyOffset = heap.size();
+        if constexpr (is_same_v<K, string>) {
+            slot.keyLength = static_cast<uint32_t>(key.size());
+            heap.append(key);
+        } else {
+            slot.keyLength = sizeof(K);
+            heap.append(reinterpret_cast<const char*>(&key), sizeof(K));
+        }
+        slot.occupied = 1;
+        memcpy(&slot.value, &value, sizeof(V));
+    });
+
+    MappedHashHeader header{};
+    memcpy(header.magic, MappedHashMagic, sizeof(header.magic));
+    header.version = MappedHashVersion;
+    header.byteOrder = MappedHashByteOrder;
+    header.keySize = is_same_v<K, string> ? 0 : static_cast<uint32_t>(sizeof(K));
+    header.valueSize = sizeof(V);
+    header.slotSize = sizeof(MappedSlot<V>);
+    header.slotCount = slotCount;
+    header.elements = source.size();
+    header.heapOffset = sizeof(MappedHashHeader) + static_cast<uint64_t>(slotCount) * sizeof(MappedSlot<V>);
+    header.heapSize = heap.size();
+    header.hashCheck = hasher(K());
+
+    ofstream outFile(filename, ios::binary);
+    if (!outFile.is_open()) {
+        throw runtime_error("Error: Could not open file for writing: " + filename);
+    }
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outFile.write(reinterpret_cast<const char*>(slots.begin()), static_cast<streamsize>(sizeof(MappedSlot<V>)) * slotCount);
+    outFile.write(heap.data(), static_cast<streamsize>(heap.size()));
+    if (!outFile) {
+        throw runtime_error("Error: Failed to write mapped hash table: " + filename);
+    }
+}
+
+// Хэш-таблица только для чтения поверх отображённого файла.
+// Открытие проверяет заголовок и размеры за O(1); смещения ключей
+// проверяются при обращении, повреждённый файл даёт исключение, а не чтение за границей
+template <typename K, typename V, typename Hash = DefaultHash<K>, typename Eq = equal_to<>>
+class MappedDoubleHash {
+    static_assert(is_trivially_copyable_v<V>, "Mapped hash values must be trivially copyable");
+
+ private:
+    using LookupKey = typename HashLookup<K>::type;
+    using Slot = MappedSlot<V>;
+
+    MappedFile file;
+    const MappedHashHeader* header;
+    const Slot* slots;
+    const char* heap;
+    Hash hasher;
+    Eq keyEq;
+
+    // Ключ ячейки из кучи; для нестроковых ключей — копия (в куче нет выравнивания)
+    auto keyAt(const Slot& slot) const {
+        if (slot.keyOffset > header->heapSize || slot.keyLength > header->heapSize - slot.keyOffset) {
+            throw runtime_error("Error: Corrupted mapped hash table (key out of range)");
+        }
+        if constexpr (is_same_v<K, string>) {
+            return string_view(heap + slot.keyOffset, slot.keyLength);
+        } else {
+            if (slot.keyLength != sizeof(K)) {
+                throw runtime_error("Error: Corrupted mapped hash table (key size)");
+            }
+            K key;
+            memcpy(&key, heap + slot.keyOffset, sizeof(K));
+            return key;
+        }
+    }
+
+ public:
+    explicit MappedDoubleHash(const string& filename, const Hash& hashFunc = Hash(), const Eq& eq = Eq())
+        : file(filename), header(nullptr), slots(nullptr), heap(nullptr), hasher(hashFunc), keyEq(eq) {
+        if (file.size() < sizeof(MappedHashHeader)) {
+            throw runtime_error("Error: File is too small for a mapped hash table: " + filename);
+        }
+        header = reinterpret_cast<const MappedHashHeader*>(file.data());
+        if (memcmp(header->magic, MappedHashMagic, sizeof(header->magic)) != 0) {
+            throw runtime_error("Error: Not a mapped hash table: " + filename);
+        }
+        if (header->version != MappedHashVersion || header->byteOrder != MappedHashByteOrder) {
+            throw runtime_error("Error: Unsupported mapped hash table version or byte order: " + filename);
+        }
+        if (header->keySize != (is_same_v<K, string> ? 0 : sizeof(K)) || header->valueSize != sizeof(V)
+            || header->slotSize != sizeof(Slot)) {
+            throw runtime_error("Error: Key or value type does not match mapped hash table: " + filename);
+        }
+        if (header->slotCount == 0 || (header->slotCount & (header->slotCount - 1)) != 0
+            || header->elements >= header->slotCount) {
+            throw runtime_error("Error: Corrupted mapped hash table header: " + filename);
+        }
+        uint64_t slotsEnd = sizeof(MappedHashHeader) + static_cast<uint64_t>(header->slotCount) * sizeof(Slot);
+        if (header->heapOffset != slotsEnd || header->heapSize > file.size()
+            || header->heapOffset > file.size() - header->heapSize) {
+            throw runtime_error("Error: Corrupted mapped hash table header: " + filename);
+        }
+        if (header->hashCheck != hasher(K())) {
+            throw runtime_error("Error: Mapped hash table was written with a different hash function: " + filename);
+        }
+        slots = reinterpret_cast<const Slot*>(file.data() + sizeof(MappedHashHeader));
+        heap = reinterpret_cast<const char*>(file.data() + header->heapOffset);
+    }
+
+    // Поиск: указатель на значение внутри отображения или nullptr.
+    // Указатель действителен, пока жив объект
+    auto find(LookupKey key) const -> const V* {
+        uint64_t h = hasher(key);
+        const uint32_t mask = header->slotCount - 1;
+        const uint32_t step = static_cast<uint32_t>(h >> 32) | 1;
+        uint32_t index = static_cast<uint32_t>(h) & mask;
+        for (uint32_t i = 0; i < header->slotCount; i++) {
+            const Slot& slot = slots[index];
+            if (!slot.occupied) return nullptr;
+            if (slot.hash == h && keyEq(keyAt(slot), key)) return &slot.value;
+            index = (index + step) & mask;
+        }
+        return nullptr;
+    }
+
+    auto contains(LookupKey key) const -> bool {
+        return find(key) != nullptr;
+    }
+
+    // Обход всех элементов: f(key, value); строковый ключ передаётся как string_view
+    template <typename F>
+    void forEach(F&& f) const {
+        for (uint32_t i = 0; i < header->slotCount; i++) {
+            if (slots[i].occupied) f(keyAt(slots[i]), slots[i].value);
+        }
+    }
+
+    [[nodiscard]] auto size() const -> uint32_t {
+        return header->elements;
+    }
+
+    [[nodiscard]] auto empty() const -> bool {
+        return header->elements == 0;
+    }
+};
+
+// Отображаемая таблица со строковыми ключами
+template <typename T, typename Hash = DefaultHash<string>>
+using MappedHash = MappedDoubleHash<string, T, Hash>;
+
+#endif   // MDH_HPP
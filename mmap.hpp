@@ -0,0 +1,146 @@
+#ifndef MMAP_HPP
+#define MMAP_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// Файл, отображённый в память только для чтения.
+// Отображение живёт, пока жив объект; объект можно перемещать, но не копировать.
+// Пустой файл отображается как пустой диапазон (data() == nullptr)
+class MappedFile {
+ private:
+    const uint8_t* base;
+    size_t length;
+#ifdef _WIN32
+    HANDLE mapping;
+#endif
+
+    void release() noexcept {
+        if (base == nullptr) return;
+#ifdef _WIN32
+        UnmapViewOfFile(base);
+        CloseHandle(mapping);
+        mapping = nullptr;
+#else
+        munmap(const_cast<uint8_t*>(base), length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+ public:
+    MappedFile() : base(nullptr), length(0)
+#ifdef _WIN32
+                 , mapping(nullptr)
+#endif
+    {}
+
+    explicit MappedFile(const string& path) : MappedFile() {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw runtime_error("Error: Could not open file for mapping: " + path);
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            CloseHandle(file);
+            throw runtime_error("Error: Could not get file size: " + path);
+        }
+        length = static_cast<size_t>(fileSize.QuadPart);
+        if (length == 0) {
+            CloseHandle(file);
+            return;
+        }
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);  // Отображение держит файл само
+        if (mapping == nullptr) {
+            length = 0;
+            throw runtime_error("Error: Could not map file: " + path);
+        }
+        base = static_cast<const uint8_t*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        if (base == nullptr) {
+            CloseHandle(mapping);
+            mapping = nullptr;
+            length = 0;
+            throw runtime_error("Error: Could not map file: " + path);
+        }
+#else
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw runtime_error("Error: Could not open file for mapping: " + path);
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw runtime_error("Error: Could not get file size: " + path);
+        }
+        length = static_cast<size_t>(st.st_size);
+        if (length == 0) {
+            close(fd);
+            return;
+        }
+        void* addr = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);  // Отображение держит файл само
+        if (addr == MAP_FAILED) {
+            length = 0;
+            throw runtime_error("Error: Could not map file: " + path);
+        }
+        base = static_cast<const uint8_t*>(addr);
+#endif
+    }
+
+    ~MappedFile() {
+        release();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    auto operator=(const MappedFile&) -> MappedFile& = delete;
+
+    MappedFile(MappedFile&& other) noexcept : MappedFile() {
+        swap(other);
+    }
+
+    auto operator=(MappedFile&& other) noexcept -> MappedFile& {
+        if (this != &other) {
+            release();
+            swap(other);
+        }
+        return *this;
+    }
+
+    void swap(MappedFile& other) noexcept {
+        std::swap(base, other.base);
+        std::swap(length, other.length);
+#ifdef _WIN32
+        std::swap(mapping, other.mapping);
+#endif
+    }
+
+    [[nodiscard]] auto data() const -> const uint8_t* {
+        return base;
+    }
+
+    [[nodiscard]] auto size() const -> size_t {
+        return length;
+    }
+};
+
+#endif   // MMAP_HPP
@@ -0,0 +1,320 @@
+#ifndef SH_HPP
+#define SH_HPP
+
+#include <iostream>
+#include <cstdint>
+#include <string>
+#include <stdexcept>
+#include <utility>
+#include "array.hpp"
+#include "dh.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SH_USE_SSE2 1
+#endif
+
+using namespace std;
+
+// Хэш-таблица с групповым пробированием (в стиле Swiss table).
+// Рядом с ячейками хранится массив управляющих байтов: 7 бит хэша для занятой
+// ячейки или маркер пустой/удалённой. Пробирование идёт группами по 16 байтов
+// одной SSE2-инструкцией, ключи сравниваются только у совпавших кандидатов.
+// API совпадает с DoubleHash: insert/find/remove/operator[]/Iterator
+template <typename T, typename Hash = WyHash>
+class SwissHash {
+ private:
+    static constexpr uint32_t GroupWidth = 16;
+    static constexpr int8_t CtrlEmpty = -128;   // 0b10000000
+    static constexpr int8_t CtrlDeleted = -2;   // 0b11111110
+    // Занятая ячейка: 0..127 (младшие 7 бит хэша)
+
+    Array<int8_t> ctrl;           // capacity + GroupWidth байтов: хвост повторяет начало
+    Array<HashNode<T>> slots;
+    uint32_t capacity;            // Степень двойки, не меньше GroupWidth
+    uint32_t elementsCount;
+    uint32_t growthLeft;          // Сколько пустых ячеек можно занять до перестройки
+    Hash hasher;
+
+    // Битовая маска ячеек группы
+    struct GroupMask {
+        uint32_t bits;
+
+        explicit operator bool() const { return bits != 0; }
+
+        uint32_t lowest() const {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<uint32_t>(__builtin_ctz(bits));
+#else
+            uint32_t i = 0;
+            while (!((bits >> i) & 1u)) i++;
+            return i;
+#endif
+        }
+
+        void clearLowest() { bits &= bits - 1; }
+    };
+
+    // Ячейки группы, в которых хранится заданный фрагмент хэша
+    static GroupMask matchHash(const int8_t* group, int8_t h2) {
+#ifdef SH_USE_SSE2
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return GroupMask{static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), g)))};
+#else
+        uint32_t bits = 0;
+        for (uint32_t i = 0; i < GroupWidth; i++) bits |= static_cast<uint32_t>(group[i] == h2) << i;
+        return GroupMask{bits};
+#endif
+    }
+
+    static GroupMask matchEmpty(const int8_t* group) {
+        return matchHash(group, CtrlEmpty);
+    }
+
+    // Пустые и удалённые ячейки: у них установлен старший бит, но это не -1
+    static GroupMask matchEmptyOrDeleted(const int8_t* group) {
+#ifdef SH_USE_SSE2
+        __m128i g = _mm_loadu_si128(reinterpret_cast<const __m128i*>(group));
+        return GroupMask{static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), g)))};
+#else
+        uint32_t bits = 0;
+        for (uint32_t i = 0; i < GroupWidth; i++) bits |= static_cast<uint32_t>(group[i] < -1) << i;
+        return GroupMask{bits};
+#endif
+    }
+
+    static bool isFull(int8_t c) { return c >= 0; }
+
+    static uint32_t h1(uint64_t h) { return static_cast<uint32_t>(h >> 7); }
+    static int8_t h2(uint64_t h) { return static_cast<int8_t>(h & 0x7f); }
+
+    // Запись управляющего байта с зеркалированием в хвост
+    void setCtrl(uint32_t index, int8_t value) {
+        int8_t* c = ctrl.begin();
+        c[index] = value;
+        if (index < GroupWidth) c[capacity + index] = value;
+    }
+
+    static uint32_t growthFor(uint32_t cap) {
+        return cap - cap / 8;  // Загрузка не выше 7/8
+    }
+
+    void initTable(uint32_t cap) {
+        capacity = cap;
+        ctrl = Array<int8_t>(capacity + GroupWidth + 1);
+        for (uint32_t i = 0; i < capacity + GroupWidth; i++) ctrl[i] = CtrlEmpty;
+        ctrl.SetSize(capacity + GroupWidth);
+        slots = Array<HashNode<T>>(capacity + 1);
+        slots.SetSize(capacity);
+        elementsCount = 0;
+        growthLeft = growthFor(capacity);
+    }
+
+    static uint32_t roundUpPow2(uint32_t n) {
+        uint32_t cap = GroupWidth;
+        while (cap < n) {
+            if (cap >= (1u << 31)) throw length_error("Error: Hash table size is too large");
+            cap <<= 1;
+        }
+        return cap;
+    }
+
+    // Поиск позиции ключа; capacity, если ключа нет
+    uint32_t findIndex(string_view key, uint64_t h) const {
+        const int8_t* c = ctrl.begin();
+        const uint32_t mask = capacity - 1;
+        uint32_t offset = h1(h) & mask;
+        const int8_t fragment = h2(h);
+        // Шаги растут на GroupWidth: треугольная последовательность обходит все группы
+        for (uint32_t step = 0; step <= capacity; step += GroupWidth) {
+            const int8_t* group = c + offset;
+            for (GroupMask m = matchHash(group, fragment); m; m.clearLowest()) {
+                uint32_t index = (offset + m.lowest()) & mask;
+                const HashNode<T>& node = slots.begin()[index];
+                if (node.hash == h && node.first == key) return index;
+            }
+            if (matchEmpty(group)) return capacity;
+            offset = (offset + step + GroupWidth) & mask;
+        }
+        return capacity;
+    }
+
+    // Первая пустая или удалённая ячейка на пути пробирования
+    uint32_t findInsertSlot(uint64_t h) const {
+        const int8_t* c = ctrl.begin();
+        const uint32_t mask = capacity - 1;
+        uint32_t offset = h1(h) & mask;
+        for (uint32_t step = 0; step <= capacity; step += GroupWidth) {
+            GroupMask m = matchEmptyOrDeleted(c + offset);
+            if (m) return (offset + m.lowest()) & mask;
+            offset = (offset + step + GroupWidth) & mask;
+        }
+        throw overflow_error("Error: Hash table is full, cannot insert key.");
+    }
+
+    // Перестройка: при большом числе удалённых ячеек размер сохраняется, иначе удваивается
+    void rehash() {
+        uint32_t newCap = capacity;
+        if (elementsCount >= growthFor(capacity) / 2) {
+            if (capacity >= (1u << 31)) throw length_error("Error: Hash table size is too large");
+            newCap = capacity * 2;
+        }
+
+        // Старые массивы забираются без копирования ключей и значений
+        Array<int8_t> oldCtrl = std::move(ctrl);
+        Array<HashNode<T>> oldSlots = std::move(slots);
+        uint32_t oldCap = capacity;
+        initTable(newCap);
+
+        for (uint32_t i = 0; i < oldCap; i++) {
+            if (isFull(oldCtrl[i])) {
+                uint64_t h = oldSlots[i].hash;  // Хэш хранится в узле и не пересчитывается
+                uint32_t index = findInsertSlot(h);
+                setCtrl(index, h2(h));
+                slots[index] = std::move(oldSlots[i]);
+                elementsCount++;
+                growthLeft--;
+            }
+        }
+    }
+
+    // Вставка нового ключа, которого точно нет в таблице
+    uint32_t insertNew(const string& key, const T& value, uint64_t h) {
+        uint32_t index = findInsertSlot(h);
+        if (growthLeft == 0 && ctrl[index] == CtrlEmpty) {
+            rehash();
+            index = findInsertSlot(h);
+        }
+        if (ctrl[index] == CtrlEmpty) growthLeft--;
+        setCtrl(index, h2(h));
+        slots[index] = HashNode<T>(key, value, h);
+        elementsCount++;
+        return index;
+    }
+
+ public:
+    struct Iterator {
+        SwissHash* owner;
+        uint32_t index;
+
+        Iterator(SwissHash* table, uint32_t startIdx) : owner(table), index(startIdx) {
+            // Проматываем пустые ячейки при создании, если мы не в конце
+            while (index < owner->capacity && !isFull(owner->ctrl[index])) {
+                index++;
+            }
+        }
+
+        HashNode<T>& operator*() { return owner->slots[index]; }
+        HashNode<T>* operator->() { return &owner->slots[index]; }
+
+        Iterator& operator++() {
+            do {
+                index++;
+            } while (index < owner->capacity && !isFull(owner->ctrl[index]));
+            return *this;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return index != other.index;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return index == other.index;
+        }
+    };
+
+    Iterator begin() { return Iterator(this, 0); }
+
+    Iterator end() { return Iterator(this, capacity); }
+
+    explicit SwissHash(uint32_t size = GroupWidth, const Hash& hashFunc = Hash()) : capacity(0)
+                                                                                  , elementsCount(0)
+                                                                                  , growthLeft(0)
+                                                                                  , hasher(hashFunc) {
+        if (size == 0) {
+            throw invalid_argument("Table size cannot be zero");
+        }
+        initTable(roundUpPow2(size));
+    }
+
+    SwissHash(const SwissHash&) = default;
+    auto operator=(const SwissHash&) -> SwissHash& = default;
+
+    // Перемещение забирает массивы без копирования узлов. other получает новую
+    // пустую таблицу минимального размера и остаётся пригодной для работы
+    SwissHash(SwissHash&& other) : capacity(0)
+                                 , elementsCount(0)
+                                 , growthLeft(0)
+                                 , hasher(other.hasher) {
+        initTable(GroupWidth);
+        swap(other);
+    }
+
+    auto operator=(SwissHash&& other) -> SwissHash& {
+        if (this != &other) {
+            SwissHash taken(std::move(other));
+            swap(taken);
+        }
+        return *this;
+    }
+
+    void swap(SwissHash& other) noexcept {
+        ctrl.swap(other.ctrl);
+        slots.swap(other.slots);
+        std::swap(capacity, other.capacity);
+        std::swap(elementsCount, other.elementsCount);
+        std::swap(growthLeft, other.growthLeft);
+        std::swap(hasher, other.hasher);
+    }
+
+    T& operator[](const string& key) {
+        uint64_t h = hasher(key);
+        uint32_t index = findIndex(key, h);
+        if (index == capacity) {
+            index = insertNew(key, T(), h);
+        }
+        return slots[index].second;
+    }
+
+    // Вставка элемента; если ключ уже есть, значение обновляется
+    void insert(const string& key, const T& value) {
+        uint64_t h = hasher(key);
+        uint32_t index = findIndex(key, h);
+        if (index != capacity) {
+            slots[index].second = value;
+            return;
+        }
+        insertNew(key, value, h);
+    }
+
+    // Поиск без создания временной std::string
+    auto find(string_view key) -> Iterator {
+        if (elementsCount == 0) return end();
+        uint32_t index = findIndex(key, hasher(key));
+        return index == capacity ? end() : Iterator(this, index);
+    }
+
+    auto remove(string_view key) -> bool {
+        if (elementsCount == 0) return false;
+        uint32_t index = findIndex(key, hasher(key));
+        if (index == capacity) return false;
+        setCtrl(index, CtrlDeleted);
+        slots[index] = HashNode<T>();
+        elementsCount--;
+        return true;
+    }
+
+    [[nodiscard]] auto size() const -> uint32_t {
+        return elementsCount;
+    }
+
+    [[nodiscard]] auto empty() const -> bool {
+        return elementsCount == 0;
+    }
+
+    void clear() {
+        initTable(capacity);
+    }
+};
+
+#endif   // SH_HPP
@@ -0,0 +1,130 @@
+// Многопоточные проверки ConcurrentDoubleHash.
+// Сборка: g++ -std=c++17 -pthread -I.. cdh_test.cpp && ./a.out
+// (с -fsanitize=thread проверяется и отсутствие гонок)
+#include <cassert>
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "../cdh.hpp"
+
+using namespace std;
+
+static uint64_t total(const uint64_t (&histogram)[HashStats::Buckets]) {
+    uint64_t sum = 0;
+    for (uint64_t count : histogram) sum += count;
+    return sum;
+}
+
+// Писатели меняют свои ключи и общий набор, читатели ищут постоянные ключи.
+// После остановки потоков size() совпадает с обходом и со статистикой сегментов,
+// а число поисков в stats() — с числом вызовов find/contains у читателей
+static void testConcurrentReadersAndWriters() {
+    constexpr int Writers = 4;
+    constexpr int Readers = 4;
+    constexpr int Stable = 500;
+    constexpr int OwnKeys = 300;
+    constexpr int SharedKeys = 100;
+    constexpr int WriterSteps = 20000;
+
+    ConcurrentHash<int> table;
+    table.setStatsEnabled(true);
+    for (int i = 0; i < Stable; i++) table.insert("stable" + to_string(i), i);
+
+    atomic<bool> writersDone{false};
+    atomic<uint64_t> readerCalls{0};
+    atomic<uint64_t> insertCalls{Stable};
+    vector<unordered_map<string, int>> expected(Writers);
+    vector<thread> threads;
+
+    for (int w = 0; w < Writers; w++) {
+        threads.emplace_back([&, w] {
+            mt19937 rng(static_cast<uint32_t>(w));
+            unordered_map<string, int>& own = expected[w];
+            uint64_t inserts = 0;
+            for (int step = 0; step < WriterSteps; step++) {
+                int value = static_cast<int>(rng() % 1000000);
+                bool shared = rng() % 4 == 0;
+                string key = shared ? "shared" + to_string(rng() % SharedKeys)
+                                    : "w" + to_string(w) + "_" + to_string(rng() % OwnKeys);
+                if (rng() % 3 == 0) {
+                    bool removed = table.remove(key);
+                    if (!shared) assert(removed == (own.erase(key) == 1));
+                } else {
+                    table.insert(key, value);
+                    inserts++;
+                    if (!shared) own[key] = value;
+                }
+            }
+            insertCalls.fetch_add(inserts);
+        });
+    }
+
+    for (int r = 0; r < Readers; r++) {
+        threads.emplace_back([&, r] {
+            mt19937 rng(static_cast<uint32_t>(100 + r));
+            uint64_t calls = 0;
+            while (!writersDone.load()) {
+                int i = static_cast<int>(rng() % Stable);
+                optional<int> value = table.find("stable" + to_string(i));
+                assert(value && *value == i);
+                assert(!table.contains("missing" + to_string(i)));
+                table.contains("shared" + to_string(rng() % SharedKeys));
+                calls += 3;
+            }
+            readerCalls.fetch_add(calls);
+        });
+    }
+
+    // Обход и статистика посреди записи: каждый сегмент виден по своему снимку
+    threads.emplace_back([&] {
+        while (!writersDone.load()) {
+            uint32_t seen = 0;
+            table.forEach([&seen](const string&, int) { seen++; });
+            assert(seen >= Stable);
+            assert(table.stats().elements >= Stable);
+        }
+    });
+
+    for (int w = 0; w < Writers; w++) threads[w].join();
+    writersDone.store(true);
+    for (size_t t = Writers; t < threads.size(); t++) threads[t].join();
+
+    // Счётчик элементов сходится с содержимым сегментов
+    uint32_t seen = 0;
+    unordered_map<string, int> contents;
+    table.forEach([&](const string& key, int value) {
+        seen++;
+        contents[key] = value;
+    });
+    assert(contents.size() == seen);
+    assert(table.size() == seen);
+
+    HashStats stats = table.stats();
+    assert(stats.elements == seen);
+
+    // Собственные ключи писателей детерминированы
+    for (int i = 0; i < Stable; i++) assert(contents.at("stable" + to_string(i)) == i);
+    size_t ownTotal = 0;
+    for (const auto& own : expected) {
+        for (const auto& [key, value] : own) assert(contents.at(key) == value);
+        ownTotal += own.size();
+    }
+    size_t sharedTotal = 0;
+    for (const auto& [key, value] : contents) sharedTotal += key.compare(0, 6, "shared") == 0;
+    assert(contents.size() == Stable + ownTotal + sharedTotal);
+
+    // Поиски читателей учтены в сегментах, записи — в снимках таблиц
+    assert(total(stats.findProbes) == readerCalls.load());
+    assert(total(stats.insertProbes) == insertCalls.load());
+    assert(readerCalls.load() > 0);
+}
+
+int main() {
+    testConcurrentReadersAndWriters();
+    cout << "cdh_test: OK" << endl;
+    return 0;
+}
@@ -0,0 +1,219 @@
+// Проверки BasicDoubleHash. Сборка: g++ -std=c++17 -I.. dh_test.cpp && ./a.out
+#include <cassert>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include "../dh.hpp"
+
+using namespace std;
+
+// Значение без присваивания: try_emplace должен конструировать его на месте,
+// счётчик копий показывает, что временных объектов не было
+struct Counted {
+    int value = 0;
+    int copies = 0;
+    Counted() = default;
+    explicit Counted(int v) : value(v) {}
+    Counted(const Counted& other) : value(other.value), copies(other.copies + 1) {}
+    Counted& operator=(const Counted&) = delete;
+    Counted& operator=(Counted&&) = delete;
+};
+
+static void testInsertAfterMove() {
+    DoubleHash<int> source;
+    source.insert("a", 1);
+    source.insert("b", 2);
+
+    DoubleHash<int> moved(std::move(source));
+    assert(moved.size() == 2);
+    assert(source.size() == 0);
+    assert(source.find("a") == source.end());
+
+    // Таблица, из которой перемещали, пригодна для дальнейшей работы
+    for (int i = 0; i < 100; i++) source.insert("key" + to_string(i), i);
+    assert(source.size() == 100);
+    assert(source.find("key42")->second == 42);
+
+    DoubleHash<int> assigned;
+    assigned = std::move(moved);
+    moved.insert("c", 3);
+    assert(moved.find("c")->second == 3);
+    assert(assigned.find("b")->second == 2);
+}
+
+static void testTryEmplaceInPlace() {
+    DoubleHash<Counted> table;
+    auto [it, inserted] = table.try_emplace("x", 7);
+    assert(inserted);
+    assert(it->second.value == 7);
+    assert(it->second.copies == 0);
+    assert(!table.try_emplace("x", 8).second);
+    assert(table.find("x")->second.value == 7);
+}
+
+// Содержимое таблицы совпадает с эталоном: и обход (включая ещё не перенесённые
+// ячейки старой таблицы), и поиск без продвижения миграции
+static void checkSame(const DoubleHash<int>& table, const unordered_map<string, int>& reference) {
+    assert(table.size() == reference.size());
+    size_t seen = 0;
+    table.forEach([&](const string& key, int value) {
+        auto it = reference.find(key);
+        assert(it != reference.end());
+        assert(it->second == value);
+        seen++;
+    });
+    assert(seen == reference.size());
+    for (const auto& [key, value] : reference) {
+        const int* found = table.get(key);
+        assert(found != nullptr);
+        assert(*found == value);
+    }
+}
+
+// Сохранение посреди миграции и загрузка в новую таблицу
+static void checkRoundTrip(const DoubleHash<int>& table, const unordered_map<string, int>& reference) {
+    const char* textFile = "dh_test_incremental.txt";
+    const char* binFile = "dh_test_incremental.bin";
+    table.serialize_text(textFile);
+    table.serialize_bin(binFile);
+    DoubleHash<int> fromText;
+    fromText.deserialize_text(textFile);
+    checkSame(fromText, reference);
+    DoubleHash<int> fromBin;
+    fromBin.deserialize_bin(binFile);
+    checkSame(fromBin, reference);
+    remove(textFile);
+    remove(binFile);
+}
+
+// Случайные операции с инкрементальным расширением по одной ячейке за запись:
+// большая часть операций приходится на незавершённую миграцию
+static void testIncrementalAgainstReference() {
+    DoubleHash<int> table;
+    table.setIncrementalResize(true, 1);
+    unordered_map<string, int> reference;
+    mt19937 rng(36);
+    uint32_t stepsDuringMigration = 0;
+    uint32_t roundTrips = 0;
+    uint32_t copies = 0;
+
+    for (uint32_t i = 0; i < 200000; i++) {
+        // Ключей больше, чем удаляется: таблица растёт и проходит много миграций
+        string key = "k" + to_string(rng() % (i / 4 + 16));
+        int value = static_cast<int>(rng());
+        bool resizing = table.isResizing();
+        if (resizing) stepsDuringMigration++;
+
+        switch (rng() % 6) {
+            case 0:
+            case 1:
+                table.insert(key, value);
+                reference[key] = value;
+                break;
+            case 2:
+                table[key] = value;
+                reference[key] = value;
+                break;
+            case 3:
+                assert(table.remove(key) == (reference.erase(key) == 1));
+                break;
+            case 4: {
+                auto it = table.find(key);
+                auto ref = reference.find(key);
+                assert((it == table.end()) == (ref == reference.end()));
+                if (ref != reference.end()) assert(it->second == ref->second);
+                break;
+            }
+            case 5: {
+                const int* found = table.get(key);
+                auto ref = reference.find(key);
+                assert((found == nullptr) == (ref == reference.end()));
+                if (found) assert(*found == ref->second);
+                break;
+            }
+        }
+
+        if (resizing && i % 97 == 0) checkSame(table, reference);
+        if (resizing && roundTrips < 3 && reference.size() > 1000) {
+            checkRoundTrip(table, reference);
+            roundTrips++;
+        }
+
+        // Копия и перемещение посреди миграции: обе таблицы дальше живут независимо
+        if (table.isResizing() && copies < 20 && i % 13 == 0) {
+            DoubleHash<int> copy(table);
+            checkSame(copy, reference);
+            unordered_map<string, int> copyReference = reference;
+            for (int k = 0; k < 200; k++) {
+                string extra = "copy" + to_string(k);
+                copy.insert(extra, k);
+                copyReference[extra] = k;
+                if (k % 3 == 0) {
+                    string gone = "k" + to_string(rng() % (i / 4 + 16));
+                    assert(copy.remove(gone) == (copyReference.erase(gone) == 1));
+                }
+            }
+            checkSame(copy, copyReference);
+            checkSame(table, reference);
+
+            DoubleHash<int> assigned;
+            assigned = copy;
+            checkSame(assigned, copyReference);
+
+            DoubleHash<int> moved(std::move(copy));
+            checkSame(moved, copyReference);
+            copy.insert("again", 1);
+            assert(copy.size() == 1);
+            moved.insert("after-move", 2);
+            copyReference["after-move"] = 2;
+            checkSame(moved, copyReference);
+            copies++;
+        }
+    }
+
+    assert(stepsDuringMigration > 10000);
+    assert(roundTrips == 3);
+    assert(copies == 20);
+    checkSame(table, reference);
+
+    // Обход через итератор доводит миграцию до конца
+    size_t iterated = 0;
+    for (auto& node : table) {
+        assert(reference.at(node.first) == node.second);
+        iterated++;
+    }
+    assert(iterated == reference.size());
+    assert(!table.isResizing());
+}
+
+// Повреждённый заголовок с огромным размером таблицы: ошибка чтения,
+// а не попытка выделить память под 2^31 ячеек
+static void testCorruptBinaryHeader() {
+    const char* file = "dh_test_corrupt.bin";
+    {
+        ofstream out(file, ios::binary);
+        uint32_t header[2] = {1u << 31, 5};
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+    }
+    DoubleHash<int> table;
+    bool failed = false;
+    try {
+        table.deserialize_bin(file);
+    } catch (const runtime_error&) {
+        failed = true;
+    }
+    assert(failed);
+    remove(file);
+}
+
+int main() {
+    testInsertAfterMove();
+    testTryEmplaceInPlace();
+    testIncrementalAgainstReference();
+    testCorruptBinaryHeader();
+    cout << "dh_test: OK" << endl;
+    return 0;
+}
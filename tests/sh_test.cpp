@@ -0,0 +1,134 @@
+// Проверки SwissHash. Сборка: g++ -std=c++17 -I.. sh_test.cpp && ./a.out
+#include <cassert>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include "../sh.hpp"
+
+using namespace std;
+
+// Хэш с малым числом стартовых групп: длинные цепочки пробирования
+// через несколько групп и удалённые ячейки на пути поиска
+struct ClusterHash {
+    uint64_t operator()(string_view key) const {
+        uint64_t h = WyHash()(key);
+        return (h & 0x7f) | ((h >> 7 & 3) << 7);
+    }
+};
+
+template <typename Table>
+static void checkSame(Table& table, const unordered_map<string, int>& reference) {
+    assert(table.size() == reference.size());
+    uint32_t seen = 0;
+    for (auto& node : table) {
+        auto it = reference.find(node.first);
+        assert(it != reference.end());
+        assert(it->second == node.second);
+        seen++;
+    }
+    assert(seen == reference.size());
+    for (const auto& [key, value] : reference) {
+        auto it = table.find(key);
+        assert(it != table.end());
+        assert(it->second == value);
+    }
+}
+
+// Случайные вставки, обновления и удаления в сравнении с unordered_map
+template <typename Hash>
+static void testRandomAgainstReference(uint32_t keySpace, uint32_t steps) {
+    SwissHash<int, Hash> table;
+    unordered_map<string, int> reference;
+    mt19937 rng(keySpace);
+    for (uint32_t i = 0; i < steps; i++) {
+        string key = "k" + to_string(rng() % keySpace);
+        int value = static_cast<int>(rng());
+        switch (rng() % 4) {
+            case 0:
+            case 1:
+                table.insert(key, value);
+                reference[key] = value;
+                break;
+            case 2:
+                assert(table.remove(key) == (reference.erase(key) == 1));
+                break;
+            case 3: {
+                auto it = table.find(key);
+                auto ref = reference.find(key);
+                assert((it == table.end()) == (ref == reference.end()));
+                if (ref != reference.end()) assert(it->second == ref->second);
+                break;
+            }
+        }
+        if (i % 1024 == 0) checkSame(table, reference);
+    }
+    checkSame(table, reference);
+}
+
+// Удалённые ячейки переиспользуются или вычищаются перестройкой без роста:
+// не больше 4 живых ключей при любом числе циклов вставки и удаления
+// не раздувают таблицу
+static void testTombstoneReuse() {
+    SwissHash<int> table;
+    const uint32_t initialCapacity = table.end().index;
+    for (int round = 0; round < 10000; round++) {
+        for (int k = 0; k < 4; k++) table.insert("r" + to_string(round) + "_" + to_string(k), k);
+        for (int k = 0; k < 4; k++) assert(table.remove("r" + to_string(round) + "_" + to_string(k)));
+        assert(table.empty());
+    }
+    assert(table.end().index == initialCapacity);
+    table.insert("last", 1);
+    assert(table.find("last")->second == 1);
+}
+
+// Рост от минимального размера: все ключи на месте после каждой перестройки
+static void testRehash() {
+    SwissHash<int> table;
+    unordered_map<string, int> reference;
+    uint32_t capacity = table.end().index;
+    uint32_t rehashes = 0;
+    for (int i = 0; i < 50000; i++) {
+        table.insert("key" + to_string(i), i);
+        reference["key" + to_string(i)] = i;
+        if (table.end().index != capacity) {
+            capacity = table.end().index;
+            rehashes++;
+            checkSame(table, reference);
+        }
+    }
+    assert(rehashes > 10);
+    checkSame(table, reference);
+}
+
+static void testInsertAfterMove() {
+    SwissHash<int> source;
+    source.insert("x", 1);
+
+    SwissHash<int> moved(std::move(source));
+    assert(moved.size() == 1);
+    assert(source.size() == 0);
+    assert(source.find("x") == source.end());
+
+    // Таблица, из которой перемещали, пригодна для дальнейшей работы
+    source.insert("y", 2);
+    assert(source.size() == 1);
+    assert(source.find("y")->second == 2);
+
+    SwissHash<int> assigned;
+    assigned = std::move(moved);
+    assert(moved.empty());
+    moved.insert("z", 3);
+    assert(moved.find("z")->second == 3);
+    assert(assigned.find("x")->second == 1);
+}
+
+int main() {
+    testRandomAgainstReference<WyHash>(2000, 200000);
+    testRandomAgainstReference<ClusterHash>(300, 50000);
+    testTombstoneReuse();
+    testRehash();
+    testInsertAfterMove();
+    cout << "sh_test: OK" << endl;
+    return 0;
+}
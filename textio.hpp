@@ -0,0 +1,184 @@
+#ifndef TEXTIO_HPP
+#define TEXTIO_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <charconv>
+#include <fstream>
+#include <istream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <stdexcept>
+#include <type_traits>
+
+using namespace std;
+
+// Текстовый ввод-вывод контейнеров (Array::MSAVE/MLOAD, DoubleHash::serialize_text).
+// Формат прежний — значения через пробельные символы, как у << и >>, — но числа
+// пишутся и разбираются через to_chars/from_chars: без локали и без потоков на
+// каждый элемент. Типы без быстрого пути (не числа и не строки) по-прежнему
+// идут через << и >>
+
+// Символьные типы поток пишет и читает как один символ, а не число
+template <typename T>
+constexpr bool IsTextChar = is_same_v<T, char> || is_same_v<T, signed char> || is_same_v<T, unsigned char>;
+
+template <typename T>
+constexpr bool IsTextNumber = is_arithmetic_v<T> && !IsTextChar<T> && !is_same_v<T, bool>;
+
+// Запись в файл через буфер: содержимое уходит в файл блоками по FlushSize
+class TextWriter {
+ private:
+    static constexpr size_t FlushSize = 1 << 20;
+
+    ofstream file;
+    string buffer;
+    string filename;
+
+    void flushIfFull() {
+        if (buffer.size() >= FlushSize) flush();
+    }
+
+ public:
+    explicit TextWriter(const string& path) : file(path, ios::binary), filename(path) {
+        if (!file.is_open()) {
+            throw runtime_error("Error: Unable to open file for writing: " + path);
+        }
+        buffer.reserve(FlushSize + 64);
+    }
+
+    void flush() {
+        file.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+        buffer.clear();
+        if (!file) {
+            throw runtime_error("Error: Write operation failed for file: " + filename);
+        }
+    }
+
+    // Запись остатка буфера; деструктор не бросает, поэтому ошибки видны только здесь
+    void close() {
+        flush();
+        file.close();
+    }
+
+    void put(char c) {
+        buffer.push_back(c);
+        flushIfFull();
+    }
+
+    template <typename T>
+    void value(const T& v) {
+        if constexpr (IsTextNumber<T>) {
+            char digits[64];
+            auto result = to_chars(digits, digits + sizeof(digits), v);
+            buffer.append(digits, result.ptr);
+        } else if constexpr (is_same_v<T, bool>) {
+            buffer.push_back(v ? '1' : '0');
+        } else if constexpr (IsTextChar<T>) {
+            buffer.push_back(static_cast<char>(v));
+        } else if constexpr (is_convertible_v<const T&, string_view>) {
+            buffer.append(string_view(v));
+        } else {
+            flush();
+            file << v;
+            if (!file) {
+                throw runtime_error("Error: Write operation failed for file: " + filename);
+            }
+        }
+        flushIfFull();
+    }
+};
+
+// Разбор файла, прочитанного в память целиком одним чтением
+class TextReader {
+ private:
+    // Поток поверх буфера без копирования — для типов, читаемых через >>
+    struct ViewBuffer : streambuf {
+        void view(char* first, char* last) { setg(first, first, last); }
+        char* position() const { return gptr(); }
+    };
+
+    string text;
+    size_t pos;
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    void skipSpace() {
+        while (pos < text.size() && isSpace(text[pos])) pos++;
+    }
+
+    // Число; ведущий '+' допускается, как у >>
+    template <typename T>
+    bool number(T& v) {
+        const char* first = text.data() + pos;
+        const char* last = text.data() + text.size();
+        if (first != last && *first == '+') first++;
+        auto result = from_chars(first, last, v);
+        if (result.ec != errc()) return false;
+        pos = static_cast<size_t>(result.ptr - text.data());
+        return true;
+    }
+
+ public:
+    explicit TextReader(const string& path) : pos(0) {
+        ifstream file(path, ios::binary | ios::ate);
+        if (!file.is_open()) {
+            throw runtime_error("Error: Unable to open file for reading: " + path);
+        }
+        text.resize(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(text.data(), static_cast<streamsize>(text.size()));
+        if (!file) {
+            throw runtime_error("Error: Failed to read file: " + path);
+        }
+    }
+
+    // Сколько байт ещё не разобрано: верхняя граница числа оставшихся значений
+    // для проверки размеров из заголовка
+    [[nodiscard]] auto remaining() const -> size_t {
+        return text.size() - pos;
+    }
+
+    // Остались ли непробельные символы
+    bool more() {
+        skipSpace();
+        return pos < text.size();
+    }
+
+    // Чтение следующего значения; false, если данных нет или они не разбираются
+    template <typename T>
+    bool value(T& v) {
+        skipSpace();
+        if (pos == text.size()) return false;
+        if constexpr (IsTextNumber<T>) {
+            return number(v);
+        } else if constexpr (is_same_v<T, bool>) {
+            unsigned flag;
+            if (!number(flag) || flag > 1) return false;
+            v = flag != 0;
+            return true;
+        } else if constexpr (IsTextChar<T>) {
+            v = static_cast<T>(text[pos++]);
+            return true;
+        } else if constexpr (is_same_v<T, string>) {
+            size_t end = pos;
+            while (end < text.size() && !isSpace(text[end])) end++;
+            v.assign(text, pos, end - pos);
+            pos = end;
+            return true;
+        } else {
+            ViewBuffer view;
+            view.view(text.data() + pos, text.data() + text.size());
+            istream in(&view);
+            if (!(in >> v)) return false;
+            pos = static_cast<size_t>(view.position() - text.data());
+            return true;
+        }
+    }
+};
+
+#endif   // TEXTIO_HPP